@@ -0,0 +1,251 @@
+/*
+ * Simulator of microcontrollers (cmd.src/cmd_profile.cc)
+ *
+ * Copyright (C) 1999,99 Drotos Daniel, Talker Bt.
+ *
+ * To contact author send email to drdani@mazsola.iit.uni-miskolc.hu
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#include "ddconfig.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "i_string.h"
+
+// sim
+#include "simcl.h"
+#include "profilecl.h"
+
+// local
+#include "cmd_profilecl.h"
+
+
+/* Profiler of the uc, created on first use */
+static class cl_profiler *
+profiler(class cl_uc *uc, class cl_console_base *con)
+{
+  if (!uc->profiler)
+    {
+      if (!uc->rom)
+	{
+	  con->dd_printf("Error: There is no ROM to profile\n");
+	  return(0);
+	}
+      uc->profiler= new cl_profiler(uc, uc->rom->get_size());
+    }
+  return(uc->profiler);
+}
+
+
+/*
+ * Command: profile start
+ *----------------------------------------------------------------------------
+ * Count executions and ticks of each ROM address and follow the calls
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_start_cmd)
+{
+  class cl_profiler *p= profiler(uc, con);
+
+  if (p)
+    p->on= true;
+  return(false);
+}
+
+
+/*
+ * Command: profile stop
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_stop_cmd)
+{
+  if (uc->profiler)
+    uc->profiler->on= false;
+  return(false);
+}
+
+
+/*
+ * Command: profile clear
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_clear_cmd)
+{
+  if (uc->profiler)
+    uc->profiler->clear();
+  return(false);
+}
+
+
+/*
+ * Command: profile save
+ *----------------------------------------------------------------------------
+ * Write one line "probe count" for every probe read from the .cdb file.
+ * sdcc --use-profile reads this file back.
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_save_cmd)
+{
+  const char *fname= 0;
+  cl_f *f;
+  t_index i;
+
+  if ((cmdline->param(0) == 0) ||
+      ((fname= cmdline->param(0)->get_svalue()) == NULL))
+    {
+      con->dd_printf("File name is missing.\n");
+      return(false);
+    }
+  if (!uc->profiler)
+    {
+      con->dd_printf("Error: Profiling was not started\n");
+      return(false);
+    }
+  if (uc->probes->count == 0)
+    {
+      con->dd_printf("Error: No probes, load the .cdb file of a program "
+		     "compiled with --debug\n");
+      return(false);
+    }
+
+  f= mk_io(fname, "w");
+  if (!f->opened())
+    {
+      con->dd_printf("Can't open `%s': %s\n", fname, strerror(errno));
+      delete f;
+      return(false);
+    }
+  for (i= 0; i < uc->probes->count; i++)
+    {
+      class cl_cdb_rec *r= (class cl_cdb_rec *)(uc->probes->at(i));
+      unsigned long n= 0;
+      if (r->addr < uc->profiler->size)
+	n= uc->profiler->counts[r->addr];
+      f->prntf("%s %lu\n", (char*)(r->fname), n);
+    }
+  con->dd_printf("%d probes written to %s\n", (int)(uc->probes->count), fname);
+  delete f;
+  return(false);
+}
+
+
+/*
+ * Command: profile symbols
+ *----------------------------------------------------------------------------
+ * Read the code symbols from a .map, .noi or .cdb file
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_symbols_cmd)
+{
+  const char *fname= 0;
+  class cl_profiler *p;
+  cl_f *f;
+
+  if ((cmdline->param(0) == 0) ||
+      ((fname= cmdline->param(0)->get_svalue()) == NULL))
+    {
+      con->dd_printf("File name is missing.\n");
+      return(false);
+    }
+  if ((p= profiler(uc, con)) == 0)
+    return(false);
+
+  f= mk_io(fname, "r");
+  if (!f->opened())
+    {
+      con->dd_printf("Can't open `%s': %s\n", fname, strerror(errno));
+      delete f;
+      return(false);
+    }
+  con->dd_printf("%ld symbols read from %s\n", p->read_symbols(f), fname);
+  delete f;
+  return(false);
+}
+
+
+/*
+ * Command: profile report
+ *----------------------------------------------------------------------------
+ * Ticks spent in each function, the top ones first
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_report_cmd)
+{
+  int lines= 20;
+
+  if (cmdline->syntax_match(uc, NUMBER))
+    lines= cmdline->param(0)->value.number;
+  else if (cmdline->param(0) != 0)
+    {
+      con->dd_printf("Error: wrong syntax\n");
+      return(false);
+    }
+  if (!uc->profiler)
+    {
+      con->dd_printf("Error: Profiling was not started\n");
+      return(false);
+    }
+  uc->profiler->report(con, lines);
+  return(false);
+}
+
+
+/*
+ * Command: profile callgrind
+ *----------------------------------------------------------------------------
+ * Write the profile in callgrind format
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_callgrind_cmd)
+{
+  const char *fname= 0;
+  cl_f *f;
+
+  if ((cmdline->param(0) == 0) ||
+      ((fname= cmdline->param(0)->get_svalue()) == NULL))
+    {
+      con->dd_printf("File name is missing.\n");
+      return(false);
+    }
+  if (!uc->profiler)
+    {
+      con->dd_printf("Error: Profiling was not started\n");
+      return(false);
+    }
+
+  f= mk_io(fname, "w");
+  if (!f->opened())
+    {
+      con->dd_printf("Can't open `%s': %s\n", fname, strerror(errno));
+      delete f;
+      return(false);
+    }
+  uc->profiler->write_callgrind(f);
+  delete f;
+  return(false);
+}
+
+
+/* End of cmd.src/cmd_profile.cc */
@@ -0,0 +1,504 @@
+/*
+ * Simulator of microcontrollers (sim.src/profile.cc)
+ *
+ * Copyright (C) 1999,99 Drotos Daniel, Talker Bt.
+ *
+ * To contact author send email to drdani@mazsola.iit.uni-miskolc.hu
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#include "ddconfig.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "i_string.h"
+
+// cmd.src
+#include "newcmdcl.h"
+
+// sim.src
+#include "uccl.h"
+#include "varcl.h"
+
+#include "profilecl.h"
+
+
+/* Calls nested deeper than this are not followed */
+#define PROF_MAX_FRAMES 4096
+
+
+cl_prof_sym::cl_prof_sym(const char *aname, t_addr aaddr):
+  cl_base()
+{
+  set_name(aname);
+  addr= aaddr;
+}
+
+cl_prof_arc::cl_prof_arc(t_addr asite, t_addr acalled):
+  cl_base()
+{
+  site= asite;
+  called= acalled;
+  calls= ticks= insts= outer_ticks= outer_insts= 0;
+}
+
+cl_prof_frame::cl_prof_frame(class cl_prof_arc *aarc, t_addr asp,
+			     unsigned long aticks, unsigned long ainsts,
+			     bool aouter):
+  cl_base()
+{
+  arc= aarc;
+  sp= asp;
+  ticks= aticks;
+  insts= ainsts;
+  outer= aouter;
+}
+
+
+/*
+ * Profiler of one microcontroller
+ */
+
+cl_profiler::cl_profiler(class cl_uc *auc, t_addr asize):
+  cl_base()
+{
+  uc= auc;
+  size= asize;
+  counts= (unsigned long *)calloc(size, sizeof(unsigned long));
+  ticks= (unsigned long *)calloc(size, sizeof(unsigned long));
+  total_ticks= total_insts= 0;
+  on= false;
+  syms= new cl_prof_syms();
+  arcs= new cl_prof_arcs();
+  frames= new cl_list(16, 16, "profile frames");
+  inst_addr= 0;
+  inst_start= 0;
+}
+
+cl_profiler::~cl_profiler(void)
+{
+  free(counts);
+  free(ticks);
+  syms->free_all();
+  delete syms;
+  arcs->free_all();
+  delete arcs;
+  frames->free_all();
+  delete frames;
+}
+
+void
+cl_profiler::clear(void)
+{
+  memset(counts, 0, size * sizeof(unsigned long));
+  memset(ticks, 0, size * sizeof(unsigned long));
+  total_ticks= total_insts= 0;
+  arcs->free_all();
+  frames->free_all();
+}
+
+/* Ticks counted so far, including the ones of the current instruction */
+unsigned long
+cl_profiler::now(void)
+{
+  return total_ticks + (uc->ticks->ticks - inst_start);
+}
+
+void
+cl_profiler::pre_inst(t_addr addr)
+{
+  inst_addr= addr;
+  inst_start= uc->ticks->ticks;
+  if (addr < size)
+    counts[addr]++;
+  total_insts++;
+}
+
+void
+cl_profiler::post_inst(void)
+{
+  unsigned long d= uc->ticks->ticks - inst_start;
+
+  if (inst_addr < size)
+    ticks[inst_addr]+= d;
+  total_ticks+= d;
+  inst_start= uc->ticks->ticks;
+}
+
+/* Follow calls and returns reported to the stack tracker. The innermost
+   call is at the top (index 0) of frames. */
+void
+cl_profiler::stack_op(class cl_stack_op *op)
+{
+  t_index i;
+
+  if (!on)
+    return;
+
+  if (op->get_op() & (stack_call|stack_intr))
+    {
+      class cl_prof_arc key(op->get_pc(),
+			    ((class cl_stack_call *)op)->get_called());
+      class cl_prof_arc *a;
+      t_addr sp= op->get_before();
+      bool up= op->sp_increased(), outer= true;
+
+      // Calls whose return address is no longer on the stack have
+      // returned without a return instruction, e.g. with a jump
+      // after removing their parameters or by longjmp()
+      for (i= frames->count - 1; i >= 0; i--)
+	{
+	  t_addr fsp= ((class cl_prof_frame *)(frames->at(i)))->sp;
+	  if (up ? (fsp > sp) : (fsp < sp))
+	    {
+	      ret(i);
+	      break;
+	    }
+	}
+      if (frames->count >= PROF_MAX_FRAMES)
+	return;
+      if (arcs->search(&key, i))
+	a= (class cl_prof_arc *)(arcs->at(i));
+      else
+	arcs->add_at(i, a= new cl_prof_arc(key.site, key.called));
+      for (i= 0; i < frames->count && outer; i++)
+	outer= ((class cl_prof_frame *)(frames->at(i)))->arc->called != a->called;
+      frames->push(new cl_prof_frame(a, op->get_after(), now(), total_insts,
+				     outer));
+    }
+  else if (op->get_op() & (stack_ret|stack_iret))
+    {
+      // The return address was pushed by the innermost call that left
+      // the stack pointer where the return finds it
+      for (i= 0; i < frames->count; i++)
+	if (((class cl_prof_frame *)(frames->at(i)))->sp == op->get_before())
+	  {
+	    ret(i);
+	    break;
+	  }
+    }
+}
+
+/* Close the calls from the innermost one to the one at level */
+void
+cl_profiler::ret(t_index level)
+{
+  for (; level >= 0; level--)
+    {
+      class cl_prof_frame *f= (class cl_prof_frame *)(frames->pop());
+      unsigned long t= now() - f->ticks, n= total_insts - f->insts;
+      f->arc->calls++;
+      f->arc->ticks+= t;
+      f->arc->insts+= n;
+      if (f->outer)
+	{
+	  f->arc->outer_ticks+= t;
+	  f->arc->outer_insts+= n;
+	}
+      delete f;
+    }
+}
+
+/* Cost of the calls on arc that did not return yet */
+int
+cl_profiler::open_cost(class cl_prof_arc *arc, bool outer,
+		       unsigned long *t, unsigned long *n)
+{
+  t_index i;
+  int calls= 0;
+
+  *t= *n= 0;
+  for (i= 0; i < frames->count; i++)
+    {
+      class cl_prof_frame *f= (class cl_prof_frame *)(frames->at(i));
+      if (f->arc == arc &&
+	  (f->outer || !outer))
+	{
+	  *t+= now() - f->ticks;
+	  *n+= total_insts - f->insts;
+	  calls++;
+	}
+    }
+  return calls;
+}
+
+
+/*
+ * Symbols
+ */
+
+bool
+cl_profiler::add_sym(const char *name, t_addr addr)
+{
+  t_index i;
+
+  if (addr >= size ||
+      syms->search(&addr, i))
+    return false;
+  syms->add_at(i, new cl_prof_sym(name, addr));
+  return true;
+}
+
+/* Index of the symbol that covers addr, -1 if none */
+int
+cl_profiler::sym_of(t_addr addr)
+{
+  t_index i;
+
+  if (syms->search(&addr, i))
+    return i;
+  return i - 1;
+}
+
+const char *
+cl_profiler::sym_name(int sym)
+{
+  if (sym < 0)
+    return "(unknown)";
+  return ((class cl_prof_sym *)(syms->at(sym)))->get_name();
+}
+
+/* Symbols of areas and sizes defined by the linker and the line and
+   scope symbols of the debug information are not functions */
+static bool
+linker_sym(const char *n)
+{
+  return (*n == '.' ||
+	  strncmp(n, "l__", 3) == 0 ||
+	  strncmp(n, "s__", 3) == 0 ||
+	  strchr(n, '$') != NULL);
+}
+
+/* Read code symbols from a .noi, .map or .cdb file */
+long
+cl_profiler::read_symbols(class cl_f *f)
+{
+  class cl_cdb_recs *fns= new cl_cdb_recs(), *locs= new cl_cdb_recs();
+  class cl_cdb_rec *r;
+  chars ln;
+  long cnt= 0;
+  char n[256];
+  unsigned long a;
+
+  ln= f->get_s();
+  while (!ln.empty())
+    {
+      const char *l= (char*)ln;
+      if (sscanf(l, "DEF %255s %li", n, (long *)&a) == 2)
+	{
+	  // NoICE: DEF name 0xaddr
+	  if (!linker_sym(n) && add_sym(n, a))
+	    cnt++;
+	}
+      else if (((l[0] == 'F') || (l[0] == 'L')) && (l[1] == ':') &&
+	       ((l[2] == 'G') || (l[2] == 'F')))
+	{
+	  // sdcc debug info, functions are G$name or Ffile$name, they
+	  // need both the F: record and the L: record of their address
+	  const char *b= strchr(l, '$');
+	  const char *e= b ? strchr(b + 1, '$') : 0;
+	  if (e && (e - l) < (int)sizeof(n))
+	    {
+	      chars key;
+	      strncpy(n, l + 2, e - l - 2);
+	      n[e - l - 2]= '\0';
+	      key= n;
+	      if (l[0] == 'F')
+		{
+		  if ((r= locs->rec(key)) != NULL)
+		    {
+		      if (add_sym(n + (b - l - 1), r->addr))
+			cnt++;
+		    }
+		  else
+		    fns->add(new cl_cdb_rec(key));
+		}
+	      else
+		{
+		  a= strtoul(strrchr(l, ':') + 1, 0, 16);
+		  if (fns->rec(key) != NULL)
+		    {
+		      if (add_sym(n + (b - l - 1), a))
+			cnt++;
+		    }
+		  else
+		    locs->add(new cl_cdb_rec(key, a));
+		}
+	    }
+	}
+      else
+	{
+	  // Linker map: addr name [module]
+	  char h[16];
+	  if ((sscanf(l, " %15s %255s", h, n) == 2) &&
+	      (strlen(h) == 4 || strlen(h) == 8) &&
+	      (strspn(h, "0123456789abcdefABCDEF") == strlen(h)) &&
+	      (isalpha((unsigned char)n[0]) || n[0] == '_') &&
+	      !linker_sym(n) &&
+	      add_sym(n, strtoul(h, 0, 16)))
+	    cnt++;
+	}
+      ln= f->get_s();
+    }
+  fns->free_all();
+  delete fns;
+  locs->free_all();
+  delete locs;
+  return cnt;
+}
+
+/* Without a symbol file, use the functions found in the .cdb file */
+void
+cl_profiler::import_vars(void)
+{
+  t_index i;
+
+  if (syms->count)
+    return;
+  for (i= 0; i < uc->vars->count; i++)
+    {
+      class cl_var *v= (class cl_var *)(uc->vars->at(i));
+      if (v->as == uc->rom)
+	add_sym(v->get_name(), v->addr);
+    }
+}
+
+
+/*
+ * Reports
+ */
+
+/* Flat profile: the symbols with most ticks spent in them */
+void
+cl_profiler::report(class cl_console_base *con, int lines)
+{
+  int n, i, j;
+  t_addr a;
+
+  import_vars();
+  n= syms->count + 1;	// [0] collects the addresses before the first symbol
+  unsigned long *self= (unsigned long *)calloc(n, sizeof(unsigned long));
+  unsigned long *insts= (unsigned long *)calloc(n, sizeof(unsigned long));
+  unsigned long *incl= (unsigned long *)calloc(n, sizeof(unsigned long));
+  unsigned long *calls= (unsigned long *)calloc(n, sizeof(unsigned long));
+  int *order= (int *)malloc(n * sizeof(int));
+
+  for (a= 0, j= -1; a < size; a++)
+    {
+      while (j + 1 < syms->count &&
+	     ((class cl_prof_sym *)(syms->at(j + 1)))->addr <= a)
+	j++;
+      self[j + 1]+= ticks[a];
+      insts[j + 1]+= counts[a];
+    }
+  for (i= 0; i < arcs->count; i++)
+    {
+      class cl_prof_arc *c= (class cl_prof_arc *)(arcs->at(i));
+      unsigned long t, m;
+      j= sym_of(c->called) + 1;
+      calls[j]+= c->calls + open_cost(c, true, &t, &m);
+      incl[j]+= c->outer_ticks + t;
+    }
+
+  for (i= 0; i < n; i++)
+    {
+      for (j= i; j > 0 && self[order[j - 1]] < self[i]; j--)
+	order[j]= order[j - 1];
+      order[j]= i;
+    }
+
+  con->dd_printf("Total %lu ticks, %lu instructions\n",
+		 total_ticks, total_insts);
+  con->dd_printf("%12s %6s %12s %10s %8s  %s\n",
+		 "self ticks", "%", "incl ticks", "insts", "calls", "symbol");
+  for (i= 0; i < n && (lines <= 0 || i < lines); i++)
+    {
+      j= order[i];
+      if (!self[j] && !calls[j])
+	break;
+      con->dd_printf("%12lu %6.2f %12lu %10lu %8lu  %s\n",
+		     self[j],
+		     total_ticks ? 100.0 * self[j] / total_ticks : 0.0,
+		     incl[j], insts[j], calls[j], sym_name(j - 1));
+    }
+
+  free(self);
+  free(insts);
+  free(incl);
+  free(calls);
+  free(order);
+}
+
+/* Callgrind format, for callgrind_annotate and KCachegrind */
+void
+cl_profiler::write_callgrind(class cl_f *f)
+{
+  t_addr a;
+  t_index i;
+  int j, sym= -2;
+
+  import_vars();
+  f->prntf("# callgrind format\n");
+  f->prntf("version: 1\n");
+  f->prntf("creator: ucsim\n");
+  f->prntf("positions: instr\n");
+  f->prntf("events: Ticks Instructions\n");
+  f->prntf("summary: %lu %lu\n", total_ticks, total_insts);
+
+  // Addresses and arcs are both sorted by address: merge them
+  for (a= 0, i= 0; a < size || i < arcs->count; )
+    {
+      class cl_prof_arc *c= (i < arcs->count) ?
+	(class cl_prof_arc *)(arcs->at(i)) : 0;
+      bool arc= c && (a >= size || c->site < a);
+      t_addr pos= arc ? c->site : a;
+
+      if (!arc && !counts[a])
+	{
+	  a++;
+	  continue;
+	}
+      if ((j= sym_of(pos)) != sym)
+	{
+	  f->prntf("\nfn=%s\n", sym_name(j));
+	  sym= j;
+	}
+      if (arc)
+	{
+	  unsigned long t, n;
+	  int open= open_cost(c, false, &t, &n);
+	  f->prntf("cfn=%s\n", sym_name(sym_of(c->called)));
+	  f->prntf("calls=%lu 0x%x\n", c->calls + open, (unsigned int)c->called);
+	  f->prntf("0x%x %lu %lu\n", (unsigned int)c->site,
+		   c->ticks + t, c->insts + n);
+	  i++;
+	}
+      else
+	{
+	  f->prntf("0x%x %lu %lu\n", (unsigned int)a, ticks[a], counts[a]);
+	  a++;
+	}
+    }
+}
+
+
+/* End of sim.src/profile.cc */
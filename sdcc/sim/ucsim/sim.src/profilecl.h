@@ -0,0 +1,146 @@
+/*
+ * Simulator of microcontrollers (sim.src/profilecl.h)
+ *
+ * Copyright (C) 1999,99 Drotos Daniel, Talker Bt.
+ *
+ * To contact author send email to drdani@mazsola.iit.uni-miskolc.hu
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#ifndef SIM_PROFILECL_HEADER
+#define SIM_PROFILECL_HEADER
+
+#include "fiocl.h"
+#include "pobjcl.h"
+
+#include "stackcl.h"
+
+
+/* A code symbol, it covers the addresses up to the next one */
+class cl_prof_sym: public cl_base
+{
+public:
+  t_addr addr;
+public:
+  cl_prof_sym(const char *aname, t_addr aaddr);
+};
+
+class cl_prof_syms: public cl_sorted_list
+{
+public:
+  cl_prof_syms(): cl_sorted_list(100, 100, "profile symbols") {}
+  virtual void *key_of(void *item)
+  { return &(((class cl_prof_sym *)item)->addr); }
+  virtual int compare(void *k1, void *k2)
+  {
+    t_addr a1= *(t_addr *)k1, a2= *(t_addr *)k2;
+    return (a1 < a2) ? -1 : ((a1 > a2) ? 1 : 0);
+  }
+};
+
+/* Calls from one call site to one address */
+class cl_prof_arc: public cl_base
+{
+public:
+  t_addr site;			// Address of the call instruction
+  t_addr called;
+  unsigned long calls;
+  unsigned long ticks;		// Ticks and instructions inside the calls
+  unsigned long insts;
+  unsigned long outer_ticks;	// The same without recursive calls
+  unsigned long outer_insts;
+public:
+  cl_prof_arc(t_addr asite, t_addr acalled);
+};
+
+class cl_prof_arcs: public cl_sorted_list
+{
+public:
+  cl_prof_arcs(): cl_sorted_list(100, 100, "profile arcs") {}
+  virtual void *key_of(void *item) { return item; }
+  virtual int compare(void *k1, void *k2)
+  {
+    class cl_prof_arc *a1= (class cl_prof_arc *)k1, *a2= (class cl_prof_arc *)k2;
+    if (a1->site != a2->site)
+      return (a1->site < a2->site) ? -1 : 1;
+    return (a1->called < a2->called) ? -1 : ((a1->called > a2->called) ? 1 : 0);
+  }
+};
+
+/* An active call */
+class cl_prof_frame: public cl_base
+{
+public:
+  class cl_prof_arc *arc;
+  t_addr sp;			// Stack pointer after the call
+  unsigned long ticks;		// Ticks and instructions at the call
+  unsigned long insts;
+  bool outer;			// The called address is not active already
+public:
+  cl_prof_frame(class cl_prof_arc *aarc, t_addr asp,
+		unsigned long aticks, unsigned long ainsts, bool aouter);
+};
+
+/* Cycle and instruction counts per code address, attributed to the
+   symbols of the program and to the calls between them. */
+class cl_profiler: public cl_base
+{
+public:
+  class cl_uc *uc;
+  t_addr size;
+  unsigned long *counts;	// Executions of each code address
+  unsigned long *ticks;		// Ticks spent at each code address
+  unsigned long total_ticks, total_insts;
+  bool on;
+  class cl_prof_syms *syms;
+protected:
+  class cl_prof_arcs *arcs;
+  class cl_list *frames;
+  t_addr inst_addr;		// Instruction being executed
+  unsigned long inst_start;	// Ticks at its start
+public:
+  cl_profiler(class cl_uc *auc, t_addr asize);
+  virtual ~cl_profiler(void);
+
+  virtual void clear(void);
+  virtual void pre_inst(t_addr addr);
+  virtual void post_inst(void);
+  virtual void stack_op(class cl_stack_op *op);
+
+  virtual bool add_sym(const char *name, t_addr addr);
+  virtual long read_symbols(class cl_f *f);
+  virtual int sym_of(t_addr addr);
+  virtual const char *sym_name(int sym);
+
+  virtual void report(class cl_console_base *con, int lines);
+  virtual void write_callgrind(class cl_f *f);
+protected:
+  virtual unsigned long now(void);
+  virtual void ret(t_index level);
+  virtual int open_cost(class cl_prof_arc *arc, bool outer,
+			unsigned long *t, unsigned long *n);
+  virtual void import_vars(void);
+};
+
+
+#endif
+
+/* End of sim.src/profilecl.h */
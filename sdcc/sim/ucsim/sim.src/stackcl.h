@@ -93,6 +93,7 @@ public:
   virtual const char *get_matching_name(void);
   virtual enum stack_op get_matching_op(void);
   virtual bool match(class cl_stack_op *op);
+  virtual t_addr get_called(void) { return(called_addr); }
 };
 
 /* Call of an ISR, must match with IRET */
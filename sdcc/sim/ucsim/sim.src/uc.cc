@@ -46,6 +46,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include "cmd_setcl.h"
 #include "cmd_infocl.h"
 #include "cmd_timercl.h"
+#include "cmd_profilecl.h"
 #include "cmd_statcl.h"
 #include "cmd_memcl.h"
 
@@ -57,6 +58,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include "itsrccl.h"
 #include "simifcl.h"
 #include "vcdcl.h"
+#include "profilecl.h"
 
 
 static class cl_uc_error_registry uc_error_registry;
@@ -255,6 +257,8 @@ cl_uc::cl_uc(class cl_sim *asim):
   isr_ticks= new cl_ticker(+1, TICK_INISR, "isr");
   idle_ticks= new cl_ticker(+1, TICK_IDLE, "idle");
   counters= new cl_list(2, 2, "counters");
+  probes= new cl_cdb_recs();
+  profiler= NULL;
   it_levels= new cl_list(2, 2, "it levels");
   it_sources= new cl_irqs(2, 2);
   class it_level *il= new it_level(-1, 0, 0, 0);
@@ -277,6 +281,10 @@ cl_uc::~cl_uc(void)
   delete isr_ticks;
   delete idle_ticks;
   delete counters;
+  probes->free_all();
+  delete probes;
+  if (profiler)
+    delete profiler;
   events->disconn_all();
   delete events;
   delete fbrk;
@@ -710,6 +718,55 @@ cmd->init();*/
     cmd->init();
   }
 
+  {
+    super_cmd= (class cl_super_cmd *)(cmdset->get_cmd("profile"));
+    if (super_cmd)
+      cset= super_cmd->get_subcommands();
+    else {
+      cset= new cl_cmdset();
+      cset->init();
+    }
+    cset->add(cmd= new cl_profile_start_cmd("start", 0,
+"profile start      Start counting executions and ticks of every code\n"
+"                   address and following the calls",
+"long help of profile start"));
+    cmd->init();
+    cmd->add_name("run");
+    cset->add(cmd= new cl_profile_stop_cmd("stop", 0,
+"profile stop       Stop counting, keep the counts",
+"long help of profile stop"));
+    cmd->init();
+    cset->add(cmd= new cl_profile_clear_cmd("clear", 0,
+"profile clear      Set all counts to zero",
+"long help of profile clear"));
+    cmd->init();
+    cset->add(cmd= new cl_profile_save_cmd("save", 0,
+"profile save file  Write the counts of the probes read from the .cdb\n"
+"                   file, for sdcc --use-profile",
+"long help of profile save"));
+    cmd->init();
+    cset->add(cmd= new cl_profile_symbols_cmd("symbols", 0,
+"profile symbols file\n"
+"                   Read code symbols from a .map, .noi or .cdb file",
+"long help of profile symbols"));
+    cmd->init();
+    cset->add(cmd= new cl_profile_report_cmd("report", 0,
+"profile report [n] Print the n functions that took most ticks",
+"long help of profile report"));
+    cmd->init();
+    cset->add(cmd= new cl_profile_callgrind_cmd("callgrind", 0,
+"profile callgrind file\n"
+"                   Write the profile in callgrind format",
+"long help of profile callgrind"));
+    cmd->init();
+  }
+  if (!super_cmd) {
+    cmdset->add(cmd= new cl_super_cmd("profile", 0,
+"profile subcommand Profile execution",
+"long help of profile", cset));
+    cmd->init();
+  }
+
   {
     class cl_super_cmd *mem_create;
     class cl_cmdset *mem_create_cset;
@@ -1248,6 +1305,21 @@ cl_uc::read_cdb_file(cl_f *f)
 		  else
 		    fns->add(new cl_cdb_rec(n, a));
 		}
+	      else if ((ln[1] == ':') &&
+		       (lc[2] == 'P') &&
+		       (lc[3] == '$'))
+		{
+		  // Profile probe emitted by sdcc --debug:
+		  // L:P$module$function$id:addr
+		  ln.start_parse(2);
+		  chars n= ln.token(":");
+		  chars t= ln.token(" ");
+		  t_addr a= strtol((char*)t, 0, 16);
+		  if ((r= probes->rec(n)) != NULL)
+		    r->addr= a;
+		  else
+		    probes->add(new cl_cdb_rec(n, a));
+		}
 	    }
 	}
       ln= f->get_s();
@@ -2196,6 +2268,8 @@ cl_uc::pre_inst(void)
   inst_ticks= 0;
   events->disconn_all();
   vc.inst++;
+  if (profiler && profiler->on)
+    profiler->pre_inst(PC);
 }
 
 int
@@ -2232,6 +2306,8 @@ cl_uc::exec_inst_tab(instruction_wrapper_fn itab[])
 void
 cl_uc::post_inst(void)
 {
+  if (profiler && profiler->on)
+    profiler->post_inst();
   tick_hw(inst_ticks);
   if (errors->count)
     check_errors();
@@ -2336,6 +2412,8 @@ cl_uc::touch(void)
 void
 cl_uc::stack_write(class cl_stack_op *op)
 {
+  if (profiler)
+    profiler->stack_op(op);
   delete op;
   return ;
   if (op->get_op() & stack_read_operation)
@@ -2352,6 +2430,8 @@ cl_uc::stack_write(class cl_stack_op *op)
 void
 cl_uc::stack_read(class cl_stack_op *op)
 {
+  if (profiler)
+    profiler->stack_op(op);
   delete op;
   return ;
   class cl_stack_op *top= (class cl_stack_op *)(stack_ops->top());
@@ -153,6 +153,8 @@ public:
   class cl_ticker *isr_ticks;	// Time in ISRs
   class cl_ticker *idle_ticks;	// Time in idle mode
   class cl_list *counters;	// User definable timers (tickers)
+  class cl_cdb_recs *probes;	// Profile probes found in .cdb files
+  class cl_profiler *profiler;	// Execution counts, created by profile start
   int inst_ticks;		// ticks of an instruction
   double xtal;			// Clock speed
   struct vcounter_t vc;		// Virtual clk counter
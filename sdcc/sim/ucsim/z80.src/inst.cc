@@ -1023,6 +1023,7 @@ cl_z80::inst_rst(t_mem code)
     case 0xC7: // RST 0
       push2(PC+2);
       PC = 0x0;
+      report_call(PC);
       vc.wr+= 2;
       break;
     case 0xCF: // RST 8
@@ -1044,31 +1045,37 @@ cl_z80::inst_rst(t_mem code)
     case 0xD7: // RST 10H
       push2(PC+2);
       PC = 0x10;
+      report_call(PC);
       vc.wr+= 2;
       break;
     case 0xDF: // RST 18H
       push2(PC+2);
       PC = 0x18;
+      report_call(PC);
       vc.wr+= 2;
       break;
     case 0xE7: // RST 20H
       push2(PC+2);
       PC = 0x20;
+      report_call(PC);
       vc.wr+= 2;
       break;
     case 0xEF: // RST 28H
       push2(PC+2);
       PC = 0x28;
+      report_call(PC);
       vc.wr+= 2;
       break;
     case 0xF7: // RST 30H
       push2(PC+2);
       PC = 0x30;
+      report_call(PC);
       vc.wr+= 2;
       break;
     case 0xFF: // RST 38H
       push2(PC+2);
       PC = 0x38;
+      report_call(PC);
       vc.wr+= 2;
       break;
     default:
@@ -1086,52 +1093,61 @@ cl_z80::inst_ret(t_mem code)
     case 0xC0: // RET NZ
       if (!(regs.raf.F & BIT_Z)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
     case 0xC8: // RET Z
       if ((regs.raf.F & BIT_Z)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
     case 0xC9: // RET
       pop2(PC);
+      report_ret(false);
       vc.rd+= 2;
       break;
     case 0xD0: // RET NC
       if (!(regs.raf.F & BIT_C)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
     case 0xD8: // RET C
       if ((regs.raf.F & BIT_C)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
     case 0xE0: // RET PO
       if (!(regs.raf.F & BIT_P)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
     case 0xE8: // RET PE
       if ((regs.raf.F & BIT_P)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
     case 0xF0: // RET P
       if (!(regs.raf.F & BIT_S)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
     case 0xF8: // RET M
       if ((regs.raf.F & BIT_S)) {
         pop2(PC);
+        report_ret(false);
 	vc.rd+= 2;
       }
       break;
@@ -1151,6 +1167,7 @@ cl_z80::inst_call(t_mem code)
       if (!(regs.raf.F & BIT_Z)) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
@@ -1160,6 +1177,7 @@ cl_z80::inst_call(t_mem code)
       if (regs.raf.F & BIT_Z) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
@@ -1168,12 +1186,14 @@ cl_z80::inst_call(t_mem code)
     case 0xCD: // CALL nnnn
       push2(PC+2);
       PC = fetch2();
+      report_call(PC);
       vc.wr+= 2;
       break;
     case 0xD4: // CALL NC,nnnn
       if (!(regs.raf.F & BIT_C)) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
@@ -1183,6 +1203,7 @@ cl_z80::inst_call(t_mem code)
       if (regs.raf.F & BIT_C) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
@@ -1192,6 +1213,7 @@ cl_z80::inst_call(t_mem code)
       if (!(regs.raf.F & BIT_P)) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
@@ -1201,6 +1223,7 @@ cl_z80::inst_call(t_mem code)
       if (regs.raf.F & BIT_P) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
@@ -1210,6 +1233,7 @@ cl_z80::inst_call(t_mem code)
       if (!(regs.raf.F & BIT_S)) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
@@ -1219,6 +1243,7 @@ cl_z80::inst_call(t_mem code)
       if (regs.raf.F & BIT_S) {
         push2(PC+2);
         PC = fetch2();
+        report_call(PC);
 	vc.wr+= 2;
       } else {
         fetch2();
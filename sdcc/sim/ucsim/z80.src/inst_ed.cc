@@ -104,6 +104,7 @@ int  cl_z80::inst_ed_(t_mem code)
       return(resGO);
     case 0x45: // RETN (return from non-maskable interrupt)
       pop2(PC);
+      report_ret(true);
       vc.rd+= 2;
       return(resGO);
 #if 0
@@ -137,6 +138,7 @@ int  cl_z80::inst_ed_(t_mem code)
       return(resGO);
     case 0x4D: // RETI (return from interrupt)
       pop2(PC);
+      report_ret(true);
       vc.rd+= 2;
       return(resGO);
     case 0x4F: // LD R,A
@@ -550,7 +550,7 @@ cl_r2k::exec_inst(void)
 {
   t_mem code;
   
-  ins_start = PC;
+  ins_start = instPC = PC;
   
   if (fetch(&code))
     return(resBREAKPOINT);
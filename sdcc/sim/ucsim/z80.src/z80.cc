@@ -563,6 +563,7 @@ cl_z80::exec_inst(void)
 {
   t_mem code;
 
+  instPC= PC;
   if (fetch(&code))
     return(resBREAKPOINT);
   tick(1);
@@ -754,6 +755,31 @@ cl_z80::exec_inst(void)
   return(resINV_INST);
 }
 
+/* Tell the stack tracker about the call or return done by the
+   instruction at instPC, after the return address was pushed or popped */
+void
+cl_z80::report_call(t_addr called)
+{
+  class cl_stack_call *o= new cl_stack_call(instPC, called, get2(regs.SP),
+					    (regs.SP + 2) & 0xffff, regs.SP);
+  o->init();
+  stack_write(o);
+}
+
+void
+cl_z80::report_ret(bool reti)
+{
+  class cl_stack_ret *o;
+  t_addr sp_before= (regs.SP - 2) & 0xffff;
+
+  if (reti)
+    o= new cl_stack_iret(instPC, PC, sp_before, regs.SP);
+  else
+    o= new cl_stack_ret(instPC, PC, sp_before, regs.SP);
+  o->init();
+  stack_read(o);
+}
+
 void cl_z80::store1( u16_t addr, t_mem val ) {
   ram->write(addr, val);
 }
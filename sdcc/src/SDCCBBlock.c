@@ -66,7 +66,7 @@ neweBBlock ()
 {
   eBBlock *ebb;
 
-  ebb = Safe_alloc (sizeof (eBBlock));
+  ebb = Func_alloc (sizeof (eBBlock));
   return ebb;
 }
 
@@ -78,7 +78,7 @@ newEdge (eBBlock * from, eBBlock * to)
 {
   edge *ep;
 
-  ep = Safe_alloc (sizeof (edge));
+  ep = Func_alloc (sizeof (edge));
 
   ep->from = from;
   ep->to = to;
@@ -563,7 +563,7 @@ iCodeBreakDown (iCode * ic)
   iCode *loop = ic;
   ebbIndex *ebbi;
 
-  ebbi = Safe_alloc (sizeof (ebbIndex));
+  ebbi = Func_alloc (sizeof (ebbIndex));
   ebbi->count = 0;
   ebbi->dfOrder = NULL;         /* no depth first order information yet */
 
@@ -53,27 +53,255 @@ FileBaseName (const char *fileFullName)
   return p + 1;
 }
 
-void
-dbuf_tvprintf (struct dbuf_s *dbuf, const char *format, va_list ap)
+/* A format string of dbuf_tvprintf is compiled once into an asmTemplate:
+   the !tokens are expanded and the result is split into literal text,
+   the %[CFIN] specials and the conversions of the arguments. Templates
+   are cached by the text of the format string, so a line is rendered
+   by concatenating the parts without parsing the format again. */
+
+enum asmPartType
 {
-  /*
-     Under Linux PPC va_list is a structure instead of a primitive type,
-     and doesn't like being passed around.  This version turns everything
-     into one function.
+  ASM_PART_TEXT,                /* literal text */
+  ASM_PART_CODE,                /* %C code segment name */
+  ASM_PART_FILE,                /* %F source file name */
+  ASM_PART_FUNC,                /* %N current function name */
+  ASM_PART_ID,                  /* %I unique id */
+  ASM_PART_STR,                 /* plain %s */
+  ASM_PART_DEC,                 /* plain %d */
+  ASM_PART_INT,                 /* other conversions of an int ... */
+  ASM_PART_LONG,                /* ... a long */
+  ASM_PART_LLONG,               /* ... a long long */
+  ASM_PART_DOUBLE,              /* ... a double */
+  ASM_PART_PTR,                 /* ... a pointer or a string */
+};
 
-     Supports:
-      !tokens
-      %[CIFN] - special formats with no argument (ie list isnt touched)
-      All of the system formats
+typedef struct asmPart
+{
+  enum asmPartType type;
+  char *text;                   /* literal text or the printf conversion */
+  size_t len;
+} asmPart;
 
-     This is acheived by expanding the tokens and zero arg formats into
-     one big format string, which is passed to the native printf.
-   */
-  static int count;
+typedef struct asmTemplate
+{
+  char *format;                 /* the format string compiled */
+  asmPart *parts;
+  int nparts;
+  bool vprintf;                 /* conversions too complex, use dbuf_vprintf () */
+} asmTemplate;
+
+/* Templates of format strings that are built at run time are not kept
+   beyond this many. */
+#define ASM_TEMPLATES_MAX 4096
+#define ASM_TEMPLATES_HASH 1021
+
+static hTab *_templates;
+static int _ntemplates;
+
+static unsigned int
+strHash (const char *s)
+{
+  unsigned int h = 2166136261u;
+
+  while (*s)
+    h = (h ^ (unsigned char) *s++) * 16777619u;
+
+  return h;
+}
+
+static int
+strCompare (const void *s1, const void *s2)
+{
+  return !strcmp (s1, s2);
+}
+
+static void
+addPart (asmTemplate *tpl, enum asmPartType type, const char *text, size_t len)
+{
+  asmPart *part;
+
+  /* Merge literal text */
+  if (type == ASM_PART_TEXT && tpl->nparts && tpl->parts[tpl->nparts - 1].type == ASM_PART_TEXT)
+    {
+      part = &tpl->parts[tpl->nparts - 1];
+      part->text = Safe_realloc (part->text, part->len + len + 1);
+      memcpy (part->text + part->len, text, len);
+      part->len += len;
+      part->text[part->len] = '\0';
+      return;
+    }
+
+  tpl->parts = Safe_realloc (tpl->parts, (tpl->nparts + 1) * sizeof (asmPart));
+  part = &tpl->parts[tpl->nparts++];
+  part->type = type;
+  part->text = NULL;
+  part->len = len;
+  if (text)
+    {
+      part->text = Safe_alloc (len + 1);
+      memcpy (part->text, text, len);
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* addConversion - adds the printf conversion at sz, returns the   */
+/*                 end of it or NULL if it is not supported        */
+/*-----------------------------------------------------------------*/
+static const char *
+addConversion (asmTemplate *tpl, const char *sz)
+{
+  const char *p = sz + 1;
+  int longs = 0;
+  enum asmPartType type;
+
+  if (*p == '%')
+    {
+      addPart (tpl, ASM_PART_TEXT, "%", 1);
+      return p + 1;
+    }
+
+  p += strspn (p, "-+ #0");
+  p += strspn (p, "0123456789");
+  if (*p == '.')
+    {
+      ++p;
+      p += strspn (p, "0123456789");
+    }
+  if (*p == 'h')
+    p += p[1] == 'h' ? 2 : 1;
+  else if (*p == 'l')
+    {
+      longs = p[1] == 'l' ? 2 : 1;
+      p += longs;
+    }
+
+  switch (*p)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+      type = longs == 2 ? ASM_PART_LLONG : longs ? ASM_PART_LONG : ASM_PART_INT;
+      if (p == sz + 1 && *p == 'd')
+        type = ASM_PART_DEC;
+      break;
+
+    case 's':
+      if (longs)
+        return NULL;
+      type = p == sz + 1 ? ASM_PART_STR : ASM_PART_PTR;
+      break;
+
+    case 'p':
+      type = ASM_PART_PTR;
+      break;
+
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+      type = ASM_PART_DOUBLE;
+      break;
+
+    default:
+      /* %*d, %n, %z... */
+      return NULL;
+    }
+
+  ++p;
+  addPart (tpl, type, sz, p - sz);
+  return p;
+}
+
+/*-----------------------------------------------------------------*/
+/* splitFormat - splits off the macros that we own and, unless raw, */
+/*               the conversions, returns FALSE if one of these is  */
+/*               not supported                                      */
+/*-----------------------------------------------------------------*/
+static bool
+splitFormat (asmTemplate *tpl, const char *sz, bool raw)
+{
+  while (*sz)
+    {
+      const char *next;
+
+      if (*sz != '%')
+        {
+          next = strchr (sz, '%');
+          if (!next)
+            next = sz + strlen (sz);
+          addPart (tpl, ASM_PART_TEXT, sz, next - sz);
+          sz = next;
+          continue;
+        }
+
+      switch (sz[1])
+        {
+        case 'C':
+          // Code segment name.
+          addPart (tpl, ASM_PART_CODE, NULL, 0);
+          sz += 2;
+          break;
+
+        case 'F':
+          // Source file name.
+          addPart (tpl, ASM_PART_FILE, NULL, 0);
+          sz += 2;
+          break;
+
+        case 'N':
+          // Current function name.
+          addPart (tpl, ASM_PART_FUNC, NULL, 0);
+          sz += 2;
+          break;
+
+        case 'I':
+          // Unique ID.
+          addPart (tpl, ASM_PART_ID, NULL, 0);
+          sz += 2;
+          break;
+
+        default:
+          // Not one of ours.
+          if (raw)
+            {
+              /* Copy until the end. */
+              next = sz + 1;
+              while (*next && !isalpha ((unsigned char) *next))
+                next++;
+              if (*next)
+                next++;
+              addPart (tpl, ASM_PART_TEXT, sz, next - sz);
+            }
+          else if (!(next = addConversion (tpl, sz)))
+            return FALSE;
+          sz = next;
+          break;
+        }
+    }
+
+  return TRUE;
+}
+
+/*-----------------------------------------------------------------*/
+/* compileTemplate - parses a format string of dbuf_tvprintf       */
+/*-----------------------------------------------------------------*/
+static asmTemplate *
+compileTemplate (const char *format)
+{
+  asmTemplate *tpl = Safe_alloc (sizeof (asmTemplate));
   struct dbuf_s tmpDBuf;
   const char *noTokens;
   const char *sz = format;
   const char *begin = NULL;
+  int i;
+
+  tpl->format = Safe_strdup (format);
 
   /* First pass: expand all of the macros */
   dbuf_init (&tmpDBuf, INITIAL_INLINEASM);
@@ -128,81 +356,178 @@ dbuf_tvprintf (struct dbuf_s *dbuf, const char *format, va_list ap)
       begin = NULL;
     }
 
-  /* Second pass: Expand any macros that we own */
-  sz = noTokens = dbuf_detach_c_str (&tmpDBuf);
+  noTokens = dbuf_detach_c_str (&tmpDBuf);
 
-  /* recycle tmpDBuf */
-  dbuf_init (&tmpDBuf, INITIAL_INLINEASM);
+  /* Second pass: split off the macros that we own and the conversions */
+  if (!splitFormat (tpl, noTokens, FALSE))
+    {
+      /* Leave the conversions to vsprintf */
+      for (i = 0; i < tpl->nparts; i++)
+        Safe_free (tpl->parts[i].text);
+      tpl->nparts = 0;
+      tpl->vprintf = TRUE;
+      splitFormat (tpl, noTokens, TRUE);
+    }
 
-  while (*sz)
+  dbuf_free (noTokens);
+
+  return tpl;
+}
+
+static void
+freeTemplate (asmTemplate *tpl)
+{
+  int i;
+
+  for (i = 0; i < tpl->nparts; i++)
+    Safe_free (tpl->parts[i].text);
+  Safe_free (tpl->parts);
+  Safe_free (tpl->format);
+  Safe_free (tpl);
+}
+
+/*-----------------------------------------------------------------*/
+/* clearTemplates - forgets the templates, the tokens changed      */
+/*-----------------------------------------------------------------*/
+static void
+clearTemplates (void)
+{
+  asmTemplate *tpl;
+  int key;
+
+  for (tpl = hTabFirstItem (_templates, &key); tpl; tpl = hTabNextItem (_templates, &key))
+    freeTemplate (tpl);
+  if (_templates)
     {
-      if (*sz == '%')
-        {
-          if (begin)
-            {
-              /* copy what we have until now */
-              dbuf_append (&tmpDBuf, begin, sz - begin);
-              begin = NULL;
-            }
+      hTabDeleteAll (_templates);
+      Safe_free (_templates);
+      _templates = NULL;
+    }
+  _ntemplates = 0;
+}
 
-          // See if its one that we handle.
-          ++sz;
-          switch (*sz)
-            {
-            case 'C':
-              // Code segment name.
-              dbuf_append_str (&tmpDBuf, CODE_NAME);
-              ++sz;
-              break;
-
-            case 'F':
-              // Source file name.
-              dbuf_append_str (&tmpDBuf, fullSrcFileName);
-              ++sz;
-              break;
-
-            case 'N':
-              // Current function name.
-              dbuf_append_str (&tmpDBuf, currFunc->rname);
-              ++sz;
-              break;
-
-            case 'I':
-              // Unique ID.
-              dbuf_printf (&tmpDBuf, "%u", ++count);
-              ++sz;
-              break;
-
-            default:
-              // Not one of ours.  Copy until the end.
-              dbuf_append_char (&tmpDBuf, '%');
-              while (!isalpha ((unsigned char) *sz))
-                dbuf_append_char (&tmpDBuf, *sz++);
-
-              dbuf_append_char (&tmpDBuf, *sz++);
-              break;
-            }
-        }
-      else
+void
+dbuf_tvprintf (struct dbuf_s *dbuf, const char *format, va_list ap)
+{
+  /*
+     Under Linux PPC va_list is a structure instead of a primitive type,
+     and doesn't like being passed around.  This version turns everything
+     into one function.
+
+     Supports:
+      !tokens
+      %[CIFN] - special formats with no argument (ie list isnt touched)
+      All of the system formats
+
+     This is acheived by expanding the tokens and zero arg formats
+     once per format string into an asmTemplate. The arguments are
+     then formatted one by one.
+   */
+  static int count;
+  asmTemplate *tpl;
+  struct dbuf_s tmpDBuf;
+  int key, i;
+  bool keep = TRUE;
+
+  /* Lines that are already complete */
+  if (!strpbrk (format, "!%"))
+    {
+      dbuf_append_str (dbuf, format);
+      return;
+    }
+
+  if (!_templates)
+    _templates = newHashTable (ASM_TEMPLATES_HASH);
+  key = strHash (format) % ASM_TEMPLATES_HASH;
+  if (!(tpl = hTabFindByKey (_templates, key, format, strCompare)))
+    {
+      tpl = compileTemplate (format);
+      if ((keep = _ntemplates < ASM_TEMPLATES_MAX))
         {
-          if (!begin)
-            begin = sz;
-          ++sz;
+          hTabAddItemLong (&_templates, key, tpl->format, tpl);
+          _ntemplates++;
         }
     }
 
-  if (begin)
+  if (tpl->vprintf)
+    dbuf_init (&tmpDBuf, INITIAL_INLINEASM);
+
+  for (i = 0; i < tpl->nparts; i++)
     {
-      /* copy what we have until now */
-      dbuf_append (&tmpDBuf, begin, sz - begin);
-      begin = NULL;
-    }
+      const asmPart *part = &tpl->parts[i];
+      struct dbuf_s *out = tpl->vprintf ? &tmpDBuf : dbuf;
 
-  dbuf_free (noTokens);
+      switch (part->type)
+        {
+        case ASM_PART_TEXT:
+          dbuf_append (out, part->text, part->len);
+          break;
+
+        case ASM_PART_CODE:
+          dbuf_append_str (out, CODE_NAME);
+          break;
+
+        case ASM_PART_FILE:
+          dbuf_append_str (out, fullSrcFileName);
+          break;
+
+        case ASM_PART_FUNC:
+          dbuf_append_str (out, currFunc->rname);
+          break;
+
+        case ASM_PART_ID:
+          dbuf_printf (out, "%u", ++count);
+          break;
+
+        case ASM_PART_STR:
+          dbuf_append_str (out, va_arg (ap, const char *));
+          break;
+
+        case ASM_PART_DEC:
+          {
+            char buf[16], *p = buf + sizeof (buf);
+            int v = va_arg (ap, int);
+            unsigned int u = v < 0 ? -(unsigned int) v : (unsigned int) v;
+
+            do
+              *--p = '0' + u % 10;
+            while (u /= 10);
+            if (v < 0)
+              *--p = '-';
+            dbuf_append (out, p, buf + sizeof (buf) - p);
+          }
+          break;
+
+        case ASM_PART_INT:
+          dbuf_printf (out, part->text, va_arg (ap, int));
+          break;
+
+        case ASM_PART_LONG:
+          dbuf_printf (out, part->text, va_arg (ap, long));
+          break;
+
+        case ASM_PART_LLONG:
+          dbuf_printf (out, part->text, va_arg (ap, long long));
+          break;
+
+        case ASM_PART_DOUBLE:
+          dbuf_printf (out, part->text, va_arg (ap, double));
+          break;
+
+        case ASM_PART_PTR:
+          dbuf_printf (out, part->text, va_arg (ap, void *));
+          break;
+        }
+    }
 
-  dbuf_vprintf (dbuf, dbuf_c_str (&tmpDBuf), ap);
+  if (tpl->vprintf)
+    {
+      dbuf_vprintf (dbuf, dbuf_c_str (&tmpDBuf), ap);
+      dbuf_destroy (&tmpDBuf);
+    }
 
-  dbuf_destroy (&tmpDBuf);
+  if (!keep)
+    freeTemplate (tpl);
 }
 
 void
@@ -235,6 +560,8 @@ asm_addTree (const ASM_MAPPINGS * pMappings)
 {
   const ASM_MAPPING *pMap;
 
+  clearTemplates ();
+
   /* Traverse down first */
   if (pMappings->pParent)
     asm_addTree (pMappings->pParent);
@@ -272,130 +599,122 @@ printILine (iCode * ic)
 }
 
 /*-----------------------------------------------------------------*/
-/* skipLine - skip the line from file infp                         */
+/* Source files read by printCLine, each one read only once        */
 /*-----------------------------------------------------------------*/
-static int
-skipLine (FILE * infp)
+typedef struct srcCache
 {
-  int c;
-  static char is_eof = 0;
-  size_t len = 0;
+  char *name;
+  char *text;                   /* file contents, lines NUL terminated */
+  char **lines;                 /* start of each line */
+  int nlines;
+  const char *error;            /* message if the file can't be read */
+} srcCache;
 
-  if (is_eof)
-    return 0;
+#define SRC_FILES_HASH 127
 
-  while ((c = getc (infp)) != '\n' && EOF != c)
-    ++len;
-
-  if (EOF == c)
-    {
-      if (len)
-        {
-          /* EOF in the middle of the line */
-          is_eof = 1;
-          return 1;
-        }
-      else
-        return 0;
-    }
-  else
-    return 1;
-}
+static hTab *_srcFiles;
 
 /*-----------------------------------------------------------------*/
-/* printCLine - return the c-code for this lineno                  */
+/* readSrcFile - reads a source file and indexes its lines         */
 /*-----------------------------------------------------------------*/
-/* int rewinds=0; */
-const char *
-printCLine (const char *srcFile, int lineno)
+static srcCache *
+readSrcFile (const char *name)
 {
-  static FILE *inFile = NULL;
-  static struct dbuf_s line;
-  static struct dbuf_s lastSrcFile;
-  static char dbufInitialized = 0;
-  static int inLineNo = 0;
-  size_t len;
+  srcCache *src = Safe_alloc (sizeof (srcCache));
+  struct dbuf_s text;
+  FILE *inFile;
+  char buf[4096];
+  size_t len, i;
+  int n;
 
-  if (!dbufInitialized)
-    {
-      dbuf_init (&line, 1024);
-      dbuf_init (&lastSrcFile, PATH_MAX);
-      dbufInitialized = 1;
-    }
-  else
-    {
-      /* empty the dynamic buffer */
-      dbuf_set_length (&line, 0);
-    }
+  src->name = Safe_strdup (name);
 
-  if (inFile)
+  if (!(inFile = fopen (name, "rb")))
     {
-      if (strcmp (dbuf_c_str (&lastSrcFile), srcFile) != 0)
-        {
-          fclose (inFile);
-          inFile = NULL;
-          inLineNo = 0;
-          dbuf_set_length (&lastSrcFile, 0);
-          dbuf_append_str (&lastSrcFile, srcFile);
-        }
+      /* can't open the file:
+         don't panic, just return the error message */
+      struct dbuf_s error;
+
+      dbuf_init (&error, 128);
+      dbuf_printf (&error, "ERROR: %s", strerror (errno));
+      src->error = dbuf_detach_c_str (&error);
+      return src;
     }
 
-  if (!inFile)
-    {
-      if (!(inFile = fopen (srcFile, "r")))
-        {
-          /* can't open the file:
-             don't panic, just return the error message */
-          dbuf_printf (&line, "ERROR: %s", strerror (errno));
+  dbuf_init (&text, 4096);
+  while ((len = fread (buf, 1, sizeof (buf), inFile)))
+    dbuf_append (&text, buf, len);
+  fclose (inFile);
 
-          return dbuf_detach_c_str (&line);
-        }
-      else
-        {
-          dbuf_set_length (&lastSrcFile, 0);
-          dbuf_append_str (&lastSrcFile, srcFile);
-        }
-    }
-
-  if (inLineNo > lineno)
-    {
-      /* past the lineno: rewind the file pointer */
-      rewind (inFile);
-      inLineNo = 0;
-      /* rewinds++; */
-    }
+  len = dbuf_get_length (&text);
+  src->text = dbuf_detach_c_str (&text);
 
-  /* skip lines until lineno */
-  while (inLineNo + 1 < lineno)
-    {
-      if (!skipLine (inFile))
-        goto err_no_line;
-      ++inLineNo;
-    }
+  /* a line is only counted if it has a character */
+  for (i = 0; i < len; ++i)
+    if (src->text[i] == '\n')
+      ++src->nlines;
+  if (len && src->text[len - 1] != '\n')
+    ++src->nlines;
 
-  /* get the line */
-  if (0 != (len = dbuf_getline (&line, inFile)))
+  src->lines = Safe_alloc (src->nlines * sizeof (char *));
+  for (i = 0, n = 0; n < src->nlines; ++n)
     {
-      const char *inLineString;
+      char *p = src->text + i;
+      size_t end = i + strcspn (p, "\n");
 
-      ++inLineNo;
+      i = end + 1;
 
       /* remove the trailing NL */
-      dbuf_chomp (&line);
-
-      inLineString = dbuf_detach_c_str (&line);
+      if (end < len && end > 0 && src->text[end - 1] == '\r')
+        --end;
+      src->text[end] = '\0';
 
       /* skip leading spaces */
-      while (isspace (*inLineString))
-        ++inLineString;
+      while (isspace ((unsigned char) *p))
+        ++p;
+      src->lines[n] = p;
+    }
 
-      return inLineString;
+  return src;
+}
+
+/*-----------------------------------------------------------------*/
+/* printCLine - return the c-code for this lineno                  */
+/*-----------------------------------------------------------------*/
+const char *
+printCLine (const char *srcFile, int lineno)
+{
+  static srcCache *last;
+  srcCache *src = last;
+  struct dbuf_s error;
+  int key;
+
+  if (!src || strcmp (src->name, srcFile))
+    {
+      if (!_srcFiles)
+        _srcFiles = newHashTable (SRC_FILES_HASH);
+      key = strHash (srcFile) % SRC_FILES_HASH;
+      if (!(src = hTabFindByKey (_srcFiles, key, srcFile, strCompare)))
+        {
+          src = readSrcFile (srcFile);
+          hTabAddItemLong (&_srcFiles, key, src->name, src);
+        }
+      last = src;
     }
 
-err_no_line:
-  dbuf_printf (&line, "ERROR: no line number %d in file %s", lineno, srcFile);
+  if (src->error)
+    return src->error;
+
+  /* the first line is returned for line numbers below 1 */
+  if (lineno < 1)
+    lineno = 1;
+  if (lineno <= src->nlines)
+    return src->lines[lineno - 1];
+
+  dbuf_init (&error, 128);
+  dbuf_printf (&error, "ERROR: no line number %d in file %s", lineno, srcFile);
 
-  return dbuf_detach_c_str (&line);
+  return dbuf_detach_c_str (&error);
 }
 
 static const ASM_MAPPING _asxxxx_mapping[] = {
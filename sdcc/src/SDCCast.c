@@ -99,7 +99,7 @@ newAst_ (unsigned type)
 {
   ast *ex;
 
-  ex = Safe_alloc (sizeof (ast));
+  ex = Global_alloc (sizeof (ast));
 
   ex->type = type;
   ex->lineno = (noLineno ? 0 : lexLineno);
@@ -244,7 +244,7 @@ copyAst (ast * src)
   else
     addSet (&pset, src);
 
-  dest = Safe_alloc (sizeof (ast));
+  dest = Global_alloc (sizeof (ast));
   dest->type = src->type;
   dest->filename = src->filename;
   dest->lineno = src->lineno;
@@ -622,7 +622,8 @@ resolveSymbols (ast * tree)
   /* do only for leafs */
   if (IS_AST_VALUE (tree) && tree->opval.val->sym && !tree->opval.val->sym->implicit)
     {
-      symbol *csym = findSymWithLevel (SymbolTab, tree->opval.val->sym);
+      symbol *csym = tree->opval.val->sym->ltoBind ? ltoBinding (tree->opval.val->sym) :
+                     findSymWithLevel (SymbolTab, tree->opval.val->sym);
 
       /* if found in the symbol table & they are not the same */
       if (csym && tree->opval.val->sym != csym)
@@ -696,6 +697,54 @@ resolveChildren:
   return tree;
 }
 
+/*-----------------------------------------------------------------*/
+/* bindFileScope - binds the references to file scope symbols the  */
+/*                 way resolveSymbols would resolve them now        */
+/*-----------------------------------------------------------------*/
+static void
+bindFileScope (ast * tree)
+{
+  if (tree == NULL)
+    return;
+
+  if (IS_AST_VALUE (tree) && tree->opval.val->sym && !tree->opval.val->sym->islbl && !tree->opval.val->sym->implicit)
+    {
+      symbol *csym;
+
+      /* references from an inlined function are bound already */
+      if (tree->opval.val->sym->ltoBind)
+        return;
+
+      csym = findSymWithLevel (SymbolTab, tree->opval.val->sym);
+      if (csym && !csym->level)
+        tree->opval.val->sym->ltoBind = csym;
+      return;
+    }
+
+  if (tree->type == EX_OP && tree->opval.op == FOR)
+    {
+      bindFileScope (AST_FOR (tree, initExpr));
+      bindFileScope (AST_FOR (tree, condExpr));
+      bindFileScope (AST_FOR (tree, loopExpr));
+    }
+
+  if (tree->type == EX_OP && tree->opval.op == BLOCK && tree->values.sym)
+    {
+      symbol *sym;
+
+      for (sym = tree->values.sym; sym; sym = sym->next)
+        sym->isinscope = 1;
+      bindFileScope (tree->left);
+      bindFileScope (tree->right);
+      for (sym = tree->values.sym; sym; sym = sym->next)
+        sym->isinscope = 0;
+      return;
+    }
+
+  bindFileScope (tree->left);
+  bindFileScope (tree->right);
+}
+
 /*------------------------------------------------------------------------*/
 /* setAstFileLine - walks a ast tree & sets the file name and line number */
 /*------------------------------------------------------------------------*/
@@ -1296,7 +1345,7 @@ createIvalArray (ast * sym, sym_link * type, initList * ilist, ast * rootValue)
           if (iloop && (lcnt && size > lcnt))
             {
               // is this a better way? at least it won't crash
-              char *name = (IS_AST_SYM_VALUE (sym)) ? AST_SYMBOL (sym)->name : "";
+              const char *name = (IS_AST_SYM_VALUE (sym)) ? AST_SYMBOL (sym)->name : "";
               werrorfl (iloop->filename, iloop->lineno, W_EXCESS_INITIALIZERS, "array", name);
 
               break;
@@ -1372,7 +1421,7 @@ createIvalCharPtr (ast * sym, sym_link * type, ast * iexpr, ast * rootVal)
         {
           if (size > symsize)
             {
-              char *name = (IS_AST_SYM_VALUE (sym)) ? AST_SYMBOL (sym)->name : "";
+              const char *name = (IS_AST_SYM_VALUE (sym)) ? AST_SYMBOL (sym)->name : "";
 
               TYPE_TARGET_ULONG c;
               if (IS_CHAR (type->next))
@@ -1667,7 +1716,7 @@ stringToSymbol (value * val)
   dbuf_init (&dbuf, 128);
   dbuf_printf (&dbuf, "__str_%d", charLbl++);
   sym = newSymbol (dbuf_c_str (&dbuf), 0);      /* make it @ level 0 */
-  strncpyz (sym->rname, dbuf_c_str (&dbuf), SDCC_NAME_MAX);
+  sym->rname = sym->name;
   dbuf_destroy (&dbuf);
 
   /* copy the type from the value passed */
@@ -6762,12 +6811,7 @@ DEFSETFUNC (resetParmKey)
 static void
 fixupInlineLabel (symbol * sym)
 {
-  struct dbuf_s dbuf;
-
-  dbuf_init (&dbuf, 128);
-  dbuf_printf (&dbuf, "%s_%d", sym->name, inlineState.count);
-  strncpyz (sym->name, dbuf_c_str (&dbuf), SDCC_NAME_MAX);
-  dbuf_destroy (&dbuf);
+  sym->name = internPrintf ("%s_%d", sym->name, inlineState.count);
 }
 
 /*------------------------------------------------------------------*/
@@ -7077,7 +7121,7 @@ expandInlineFuncs (ast * tree, ast * block)
       currBlockno = tree->block;
 
       /* The symbol is probably not bound yet, so find the real one */
-      csym = findSymWithLevel (SymbolTab, func);
+      csym = func->ltoBind ? ltoBinding (func) : findSymWithLevel (SymbolTab, func);
       if (csym)
         func = csym;
 
@@ -7274,6 +7318,8 @@ createFunctionDecl (symbol * name)
   value *args;
   sym_link *type;
 
+  ltoDeclare (name);
+
   /* if check function return 0 then some problem */
   if (checkFunction (name, NULL) == 0)
     return NULL;
@@ -7378,7 +7424,12 @@ createFunction (symbol * name, ast * body)
   expandInlineFuncs (body, NULL);
 
   if (FUNC_ISINLINE (name->type))
-    name->funcTree = copyAst (body);
+    {
+      /* the function may be inlined into another module of a --lto source */
+      if (ltoCombined ())
+        bindFileScope (body);
+      name->funcTree = copyAst (body);
+    }
 
   allocParms (FUNC_ARGS (name->type), IFFUNC_ISSMALLC (name->type));  /* allocate the parameters */
 
@@ -7395,7 +7446,7 @@ createFunction (symbol * name, ast * body)
   processBlockVars (body, &stack, ALLOCATE);
 
   /* name needs to be mangled */
-  SNPRINTF (name->rname, sizeof (name->rname), "%s%s", port->fun_prefix, name->name);
+  name->rname = internPrintf ("%s%s", port->fun_prefix, ltoName (name));
 
   body = resolveSymbols (body); /* resolve the symbols */
   body = decorateType (body, RESULT_TYPE_NONE); /* propagateType & do semantic checks */
@@ -7416,6 +7467,10 @@ createFunction (symbol * name, ast * body)
   if (fatalError)
     goto skipall;
 
+  /* --lto found no call of the function */
+  if (ltoDropped (name))
+    goto skipall;
+
   /* Do not generate code for inline functions unless extern also. */
 #if 0
   if (FUNC_ISINLINE (name->type) && !IS_EXTERN (fetype))
@@ -7427,16 +7482,27 @@ createFunction (symbol * name, ast * body)
     goto skipall;
 #endif
 
+  /* The iCode, basic blocks and code lines of the function are released
+     in one go once its code has been emitted. The pic ports keep per
+     function data until glue time. */
+  if (!TARGET_PIC_LIKE)
+    beginFuncAlloc ();
+
+  timerBeginFunction (name->name);
+
   /* create the node & generate intermediate code */
   GcurMemmap = code;
   codeOutBuf = &code->oBuf;
+  timerBegin ("iCodeFromAst");
   piCode = iCodeFromAst (ex);
+  timerEnd ("iCodeFromAst");
   name->generated = 1;
 
   if (fatalError)
     goto skipall;
 
   eBBlockFromiCode (piCode);
+  spillCode ();
 
   /* if there are any statics then do them */
   if (staticAutos)
@@ -7467,6 +7533,10 @@ skipall:
   addSet (&operKeyReset, name);
   applyToSet (operKeyReset, resetParmKey);
 
+  endFuncAlloc ();
+
+  timerEndFunction ();
+
   if (options.debug)
     cdbStructBlock (1);
 
@@ -0,0 +1,130 @@
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation; either version 2, or (at your option) any
+// later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+//
+//
+// Per-function choice of options.max_allocs_per_node for --max-allocs-time.
+//
+// The time taken by the tree-decomposition based algorithms is roughly
+// proportional to the sum of the node sizes of the nice tree decomposition
+// times the number of assignments kept at each node. Starting
+// from a rough guess, the speed is measured on every function compiled, and
+// each function gets as many assignments per node as fit into its share of
+// the time budget. Small functions thus get a lot more than the default,
+// huge ones less.
+//
+// Usage:
+//
+// static allocs_budget budget("register allocation", 0.6, 40000);
+// ...
+// budget.begin(tree_decomposition);
+// tree_dec_ralloc(...);
+// budget.end();
+
+#ifndef SDCCBUDGET_HH
+#define SDCCBUDGET_HH 1
+
+#include <ctime>
+#include <algorithm>
+
+#include <boost/graph/graph_traits.hpp>
+
+#include "common.h"
+
+// Bounds on the number of assignments per node chosen.
+#define BUDGET_MIN_ALLOCS 200
+#define BUDGET_MAX_ALLOCS 300000
+
+// The size of a node that matters for the time spent there. Algorithms
+// that keep more than the bag in their assignments overload this.
+template <class N_t>
+size_t budget_node_width(const N_t &n)
+{
+  return(n.bag.size());
+}
+
+class allocs_budget
+{
+public:
+  // speed is a first guess, in node sizes * assignments per millisecond,
+  // replaced by measurements as soon as a run used up its budget.
+  allocs_budget(const char *pass, double share, double speed) :
+    pass(pass), share(share), units(speed), msecs(1.0), work(0), saved(0), active(false)
+  {
+  }
+
+  // Sets options.max_allocs_per_node for runs runs of the algorithm on tree decomposition T.
+  template <class T_t>
+  void begin(const T_t &T, unsigned long runs = 1)
+  {
+    typename boost::graph_traits<T_t>::vertex_iterator t, t_end;
+    size_t width = 0;
+
+    if(!options.max_allocs_time)
+      return;
+
+    work = 0;
+    for(boost::tie(t, t_end) = boost::vertices(T); t != t_end; ++t)
+      {
+        size_t w = budget_node_width(T[*t]);
+        width = std::max(width, w);
+        work += w + 1;
+      }
+    work *= std::max(runs, 1ul);
+
+    double allocs = options.max_allocs_time * share * (units / msecs) / work;
+    allocs = std::min(std::max(allocs, double(BUDGET_MIN_ALLOCS)), double(BUDGET_MAX_ALLOCS));
+
+    saved = options.max_allocs_per_node;
+    options.max_allocs_per_node = int(allocs);
+    active = true;
+
+    if(options.verbose)
+      fprintf(stderr, "%s: %s: %lu nodes, width %u, max-allocs-per-node %d\n",
+        currFunc ? currFunc->name : "?", pass, (unsigned long)boost::num_vertices(T), (unsigned int)width, options.max_allocs_per_node);
+
+    start = std::clock();
+  }
+
+  // Restores options.max_allocs_per_node and updates the speed estimate.
+  void end(void)
+  {
+    if(!active)
+      return;
+
+    double elapsed = double(std::clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+
+    // Only runs that used up a good part of their budget tell something
+    // about the speed, the others never reached the number of assignments.
+    if(elapsed >= 1.0 && elapsed >= options.max_allocs_time * share / 2)
+      {
+        units += double(work) * options.max_allocs_per_node;
+        msecs += elapsed;
+      }
+
+    options.max_allocs_per_node = saved;
+    active = false;
+  }
+
+private:
+  const char *const pass;
+  const double share;    // Part of the --max-allocs-time budget given to this pass.
+  double units, msecs;   // Work done and time spent so far, including the initial guess.
+  unsigned long work;    // Work per assignment in the current run.
+  int saved;
+  bool active;
+  std::clock_t start;
+};
+
+#endif
+
@@ -0,0 +1,631 @@
+/*-------------------------------------------------------------------------
+  SDCCcache.c - cache of compiled modules (--cache-dir)
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+/* With --cache-dir, the files produced by a compilation are stored in a
+   subdirectory of the cache that is named after a SHA-1 hash of
+   everything they depend on: the compiler build, the command line, the
+   preprocessed source and the peephole rules. A later compilation with
+   the same hash copies the stored files instead of compiling and
+   assembling again, and repeats the messages of the first compilation.
+   Only compilations without errors are stored. Once the cache holds
+   more than --cache-size MiB, the entries used least recently are
+   removed. */
+
+#include "common.h"
+#include "dbuf_string.h"
+#include <sys/stat.h>
+#include <time.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <process.h>
+#include <sys/utime.h>
+#define mkdir(path)     _mkdir (path)
+#else
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#define mkdir(path)     mkdir ((path), 0777)
+#endif
+
+/* Files of a cache entry, named by the extension of the output file.
+   "err" holds the messages and marks a complete entry. */
+static const char *const cacheFiles[] = { "asm", "rel", "lst", "sym", "adb", NULL };
+
+#define CACHE_ERR_FILE "err"
+
+static struct dbuf_s entryPath;         /* entry of this compilation */
+static FILE *errCopy;                   /* its messages, while it isn't stored yet */
+static time_t startTime;                /* outputs older than this are not stored */
+
+/*-----------------------------------------------------------------*/
+/* SHA-1 as in FIPS 180-1                                          */
+/*-----------------------------------------------------------------*/
+struct sha1
+{
+  unsigned long h[5];
+  unsigned char block[64];
+  size_t nblock;
+  unsigned long long len;
+};
+
+#define ROL32(x, n)     ((((x) << (n)) | (((x) & 0xffffffffUL) >> (32 - (n)))) & 0xffffffffUL)
+
+static void
+sha1Init (struct sha1 *ctx)
+{
+  ctx->h[0] = 0x67452301UL;
+  ctx->h[1] = 0xefcdab89UL;
+  ctx->h[2] = 0x98badcfeUL;
+  ctx->h[3] = 0x10325476UL;
+  ctx->h[4] = 0xc3d2e1f0UL;
+  ctx->nblock = 0;
+  ctx->len = 0;
+}
+
+static void
+sha1Block (struct sha1 *ctx, const unsigned char *p)
+{
+  unsigned long w[80];
+  unsigned long a, b, c, d, e, f, k, t;
+  int i;
+
+  for (i = 0; i < 16; i++)
+    w[i] = (unsigned long) p[4 * i] << 24 | (unsigned long) p[4 * i + 1] << 16 | (unsigned long) p[4 * i + 2] << 8 | p[4 * i + 3];
+  for (; i < 80; i++)
+    w[i] = ROL32 (w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+  a = ctx->h[0];
+  b = ctx->h[1];
+  c = ctx->h[2];
+  d = ctx->h[3];
+  e = ctx->h[4];
+  for (i = 0; i < 80; i++)
+    {
+      if (i < 20)
+        {
+          f = (b & c) | (~b & d);
+          k = 0x5a827999UL;
+        }
+      else if (i < 40)
+        {
+          f = b ^ c ^ d;
+          k = 0x6ed9eba1UL;
+        }
+      else if (i < 60)
+        {
+          f = (b & c) | (b & d) | (c & d);
+          k = 0x8f1bbcdcUL;
+        }
+      else
+        {
+          f = b ^ c ^ d;
+          k = 0xca62c1d6UL;
+        }
+      t = (ROL32 (a, 5) + (f & 0xffffffffUL) + e + k + w[i]) & 0xffffffffUL;
+      e = d;
+      d = c;
+      c = ROL32 (b, 30);
+      b = a;
+      a = t;
+    }
+  ctx->h[0] = (ctx->h[0] + a) & 0xffffffffUL;
+  ctx->h[1] = (ctx->h[1] + b) & 0xffffffffUL;
+  ctx->h[2] = (ctx->h[2] + c) & 0xffffffffUL;
+  ctx->h[3] = (ctx->h[3] + d) & 0xffffffffUL;
+  ctx->h[4] = (ctx->h[4] + e) & 0xffffffffUL;
+}
+
+static void
+sha1Update (struct sha1 *ctx, const void *data, size_t len)
+{
+  const unsigned char *p = data;
+
+  ctx->len += len;
+  while (len)
+    {
+      size_t n = 64 - ctx->nblock;
+
+      if (n > len)
+        n = len;
+      memcpy (ctx->block + ctx->nblock, p, n);
+      ctx->nblock += n;
+      p += n;
+      len -= n;
+      if (ctx->nblock == 64)
+        {
+          sha1Block (ctx, ctx->block);
+          ctx->nblock = 0;
+        }
+    }
+}
+
+static void
+sha1Final (struct sha1 *ctx, unsigned char digest[20])
+{
+  unsigned long long bits = ctx->len * 8;
+  unsigned char pad[64 + 8];
+  size_t npad = (ctx->nblock < 56 ? 56 : 120) - ctx->nblock;
+  int i;
+
+  memset (pad, 0, sizeof (pad));
+  pad[0] = 0x80;
+  for (i = 0; i < 8; i++)
+    pad[npad + i] = (unsigned char) (bits >> (56 - 8 * i));
+  sha1Update (ctx, pad, npad + 8);
+
+  for (i = 0; i < 20; i++)
+    digest[i] = (unsigned char) (ctx->h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+/*-----------------------------------------------------------------*/
+/* hashString - adds a string and its terminator to the hash       */
+/*-----------------------------------------------------------------*/
+static void
+hashString (struct sha1 *ctx, const char *s)
+{
+  if (s)
+    sha1Update (ctx, s, strlen (s) + 1);
+  else
+    sha1Update (ctx, "", 1);
+}
+
+/*-----------------------------------------------------------------*/
+/* hashFile - adds the contents of a file to the hash              */
+/*-----------------------------------------------------------------*/
+static void
+hashFile (struct sha1 *ctx, const char *name)
+{
+  char buf[4096];
+  size_t len;
+  FILE *f;
+
+  hashString (ctx, name);
+  if (!(f = fopen (name, "rb")))
+    return;
+  while ((len = fread (buf, 1, sizeof (buf), f)) != 0)
+    sha1Update (ctx, buf, len);
+  fclose (f);
+}
+
+/*-----------------------------------------------------------------*/
+/* outputName - name of the output file stored as ext              */
+/*-----------------------------------------------------------------*/
+static const char *
+outputName (const char *ext)
+{
+  struct dbuf_s name;
+
+  /* the same names as glue () and assemble () use */
+  if (!strcmp (ext, "asm") && noAssemble && fullDstFileName)
+    return Safe_strdup (fullDstFileName);
+  if (!strcmp (ext, "rel") && options.cc_only && fullDstFileName)
+    return Safe_strdup (fullDstFileName);
+
+  dbuf_init (&name, PATH_MAX);
+  dbuf_append_str (&name, dstFileName);
+  if (!strcmp (ext, "asm"))
+    dbuf_append_str (&name, port->assembler.file_ext);
+  else if (!strcmp (ext, "rel"))
+    dbuf_append_str (&name, port->linker.rel_ext);
+  else
+    dbuf_printf (&name, ".%s", ext);
+
+  return dbuf_detach_c_str (&name);
+}
+
+/*-----------------------------------------------------------------*/
+/* entryFile - name of a file in the cache entry                   */
+/*-----------------------------------------------------------------*/
+static const char *
+entryFile (const char *entry, const char *ext)
+{
+  struct dbuf_s name;
+
+  dbuf_init (&name, PATH_MAX);
+  dbuf_makePath (&name, entry, ext);
+
+  return dbuf_detach_c_str (&name);
+}
+
+/*-----------------------------------------------------------------*/
+/* copyFile - copies a file or the rest of an open file            */
+/*-----------------------------------------------------------------*/
+static bool
+copyStream (FILE *from, const char *to)
+{
+  char buf[4096];
+  size_t len;
+  FILE *f;
+  bool ok;
+
+  if (!(f = fopen (to, "wb")))
+    return FALSE;
+  while ((len = fread (buf, 1, sizeof (buf), from)) != 0)
+    if (fwrite (buf, 1, len, f) != len)
+      break;
+  ok = !ferror (from) && !ferror (f);
+  if (fclose (f))
+    ok = FALSE;
+
+  return ok;
+}
+
+static bool
+copyFile (const char *from, const char *to)
+{
+  FILE *f;
+  bool ok;
+
+  if (!(f = fopen (from, "rb")))
+    return FALSE;
+  ok = copyStream (f, to);
+  fclose (f);
+
+  return ok;
+}
+
+/*-----------------------------------------------------------------*/
+/* removeEntry - removes a cache entry or an unfinished one        */
+/*-----------------------------------------------------------------*/
+static void
+removeEntry (const char *entry)
+{
+  const char *const *ext;
+  const char *name;
+
+  /* "err" first, so the entry is no longer complete */
+  name = entryFile (entry, CACHE_ERR_FILE);
+  remove (name);
+  Safe_free ((void *) name);
+  for (ext = cacheFiles; *ext; ext++)
+    {
+      name = entryFile (entry, *ext);
+      remove (name);
+      Safe_free ((void *) name);
+    }
+  rmdir (entry);
+}
+
+/*-----------------------------------------------------------------*/
+/* Entries of the cache directory, to remove the oldest            */
+/*-----------------------------------------------------------------*/
+struct cacheEntry
+{
+  char *path;
+  time_t used;
+  unsigned long long size;
+};
+
+static int
+cacheEntryCmp (const void *p1, const void *p2)
+{
+  const struct cacheEntry *e1 = p1, *e2 = p2;
+
+  return (e1->used > e2->used) - (e1->used < e2->used);
+}
+
+/*-----------------------------------------------------------------*/
+/* addEntry - adds the complete entry called name to the list      */
+/*-----------------------------------------------------------------*/
+static void
+addEntry (struct dbuf_s *list, const char *name)
+{
+  const char *const *ext;
+  const char *file;
+  struct cacheEntry e;
+  struct stat st;
+
+  /* the entries are named by 40 hex digits */
+  if (strlen (name) != 40 || strspn (name, "0123456789abcdef") != 40)
+    return;
+
+  e.path = (char *) entryFile (options.cache_dir, name);
+  file = entryFile (e.path, CACHE_ERR_FILE);
+  if (stat (file, &st))
+    {
+      Safe_free ((void *) file);
+      Safe_free (e.path);
+      return;
+    }
+  Safe_free ((void *) file);
+  e.used = st.st_mtime;
+  e.size = st.st_size;
+  for (ext = cacheFiles; *ext; ext++)
+    {
+      file = entryFile (e.path, *ext);
+      if (!stat (file, &st))
+        e.size += st.st_size;
+      Safe_free ((void *) file);
+    }
+  dbuf_append (list, &e, sizeof (e));
+}
+
+/*-----------------------------------------------------------------*/
+/* trimCache - removes the least recently used entries             */
+/*-----------------------------------------------------------------*/
+static void
+trimCache (void)
+{
+  unsigned long long limit = (unsigned long long) options.cache_size << 20;
+  unsigned long long total = 0;
+  struct cacheEntry *e;
+  struct dbuf_s list;
+  size_t n, i;
+#ifdef _WIN32
+  struct _finddata_t fd;
+  intptr_t h;
+  const char *pattern = entryFile (options.cache_dir, "*");
+
+  dbuf_init (&list, 64 * sizeof (struct cacheEntry));
+  if ((h = _findfirst (pattern, &fd)) != -1)
+    {
+      do
+        addEntry (&list, fd.name);
+      while (!_findnext (h, &fd));
+      _findclose (h);
+    }
+  Safe_free ((void *) pattern);
+#else
+  struct dirent *de;
+  DIR *dir;
+
+  dbuf_init (&list, 64 * sizeof (struct cacheEntry));
+  if ((dir = opendir (options.cache_dir)))
+    {
+      while ((de = readdir (dir)))
+        addEntry (&list, de->d_name);
+      closedir (dir);
+    }
+#endif
+
+  e = (struct cacheEntry *) dbuf_get_buf (&list);
+  n = dbuf_get_length (&list) / sizeof (struct cacheEntry);
+  for (i = 0; i < n; i++)
+    total += e[i].size;
+
+  /* leave some room, so that not every compilation has to trim */
+  if (total > limit)
+    {
+      qsort (e, n, sizeof (struct cacheEntry), cacheEntryCmp);
+      for (i = 0; i < n && total > limit - limit / 8; i++)
+        {
+          removeEntry (e[i].path);
+          total -= e[i].size;
+        }
+    }
+
+  for (i = 0; i < n; i++)
+    Safe_free (e[i].path);
+  dbuf_destroy (&list);
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheKey - hash of everything the outputs depend on             */
+/*-----------------------------------------------------------------*/
+static void
+cacheKey (struct dbuf_s *src, int argc, char **argv, struct dbuf_s *key)
+{
+  unsigned char digest[20];
+  struct sha1 ctx;
+  int i;
+
+  sha1Init (&ctx);
+
+  /* the compiler build */
+  hashString (&ctx, SDCC_VERSION_STR);
+  hashString (&ctx, getBuildNumber ());
+  hashString (&ctx, __DATE__ " " __TIME__);
+
+  /* all options, the file names go into the outputs as well */
+  for (i = 1; i < argc; i++)
+    hashString (&ctx, argv[i]);
+  hashString (&ctx, dstFileName);
+  hashString (&ctx, moduleName);
+
+  /* the debug information refers to the working directory */
+  if (options.debug)
+    {
+      char cwd[PATH_MAX];
+
+      hashString (&ctx, getcwd (cwd, sizeof (cwd)) ? cwd : "");
+    }
+
+  hashString (&ctx, port->peep.default_rules);
+  if (options.peep_file)
+    hashFile (&ctx, options.peep_file);
+
+  sha1Update (&ctx, dbuf_get_buf (src), dbuf_get_length (src));
+
+  sha1Final (&ctx, digest);
+  for (i = 0; i < 20; i++)
+    dbuf_printf (key, "%02x", digest[i]);
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheRestore - copies the outputs from the cache if they are    */
+/*                there, otherwise prepares storing them           */
+/*-----------------------------------------------------------------*/
+bool
+cacheRestore (int argc, char **argv)
+{
+  const char *const *ext;
+  struct dbuf_s src;
+  struct dbuf_s key;
+  const char *name;
+  char buf[4096];
+  size_t len;
+  FILE *f;
+
+  if (!options.cache_dir || options.c1mode || TARGET_PIC_LIKE)
+    return FALSE;
+
+  /* the parser reads the preprocessed source from a copy */
+  dbuf_init (&src, 64 * 1024);
+  while ((len = fread (buf, 1, sizeof (buf), yyin)) != 0)
+    dbuf_append (&src, buf, len);
+  if (sdcc_pclose (yyin))
+    exit (EXIT_FAILURE);
+  if (!(yyin = tmpfile ()) || fwrite (dbuf_get_buf (&src), 1, dbuf_get_length (&src), yyin) != dbuf_get_length (&src))
+    {
+      werror (E_TMPFILE_FAILED);
+      exit (EXIT_FAILURE);
+    }
+  rewind (yyin);
+
+  dbuf_init (&key, 41);
+  cacheKey (&src, argc, argv, &key);
+  dbuf_destroy (&src);
+
+  mkdir (options.cache_dir);
+  dbuf_init (&entryPath, PATH_MAX);
+  dbuf_makePath (&entryPath, options.cache_dir, dbuf_c_str (&key));
+  dbuf_destroy (&key);
+
+  name = entryFile (dbuf_c_str (&entryPath), CACHE_ERR_FILE);
+  f = fopen (name, "rb");
+  if (f)
+    {
+      FILE *out = _SDCCERRG.out ? _SDCCERRG.out : stderr;
+
+      /* the .adb file was opened by parseCmdLine () */
+      if (options.debug)
+        debugFile->closeFile ();
+
+      for (ext = cacheFiles; *ext; ext++)
+        {
+          const char *from = entryFile (dbuf_c_str (&entryPath), *ext);
+          const char *to;
+
+          if (access (from, 0))
+            {
+              Safe_free ((void *) from);
+              continue;
+            }
+          to = outputName (*ext);
+          if (!copyFile (from, to))
+            {
+              werror (E_FILE_OPEN_ERR, to);
+              exit (EXIT_FAILURE);
+            }
+          Safe_free ((void *) from);
+          Safe_free ((void *) to);
+        }
+
+      /* repeat the messages */
+      while ((len = fread (buf, 1, sizeof (buf), f)) != 0)
+        fwrite (buf, 1, len, out);
+      fclose (f);
+
+      /* mark the entry as recently used */
+      utime (name, NULL);
+      Safe_free ((void *) name);
+
+      fclose (yyin);
+      yyin = NULL;
+      return TRUE;
+    }
+  Safe_free ((void *) name);
+
+  /* keep a copy of the messages for the cache */
+  if ((errCopy = tmpfile ()))
+    SetErrorCopy (errCopy);
+  startTime = time (NULL);
+
+  return FALSE;
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheMiss - the outputs are not from the cache, cacheStore ()   */
+/*             stores them                                         */
+/*-----------------------------------------------------------------*/
+bool
+cacheMiss (void)
+{
+  return errCopy != NULL;
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheStore - stores the outputs of this compilation             */
+/*-----------------------------------------------------------------*/
+void
+cacheStore (void)
+{
+  const char *const *ext;
+  struct dbuf_s tmpPath;
+  const char *name;
+  bool ok = TRUE;
+
+  if (!errCopy)
+    return;
+  SetErrorCopy (NULL);
+  if (fatalError)
+    {
+      fclose (errCopy);
+      errCopy = NULL;
+      return;
+    }
+
+  /* fill a new directory and give it the name of the entry at the end,
+     so that other compilations never see an incomplete entry */
+  dbuf_init (&tmpPath, PATH_MAX);
+  dbuf_printf (&tmpPath, "%s.%d", dbuf_c_str (&entryPath), (int) getpid ());
+  if (mkdir (dbuf_c_str (&tmpPath)))
+    {
+      fclose (errCopy);
+      errCopy = NULL;
+      dbuf_destroy (&tmpPath);
+      return;
+    }
+
+  for (ext = cacheFiles; *ext && ok; ext++)
+    {
+      const char *from = outputName (*ext);
+      struct stat st;
+
+      /* the listings may be left over from earlier compilations */
+      if (!stat (from, &st) && st.st_mtime >= startTime)
+        {
+          name = entryFile (dbuf_c_str (&tmpPath), *ext);
+          ok = copyFile (from, name);
+          Safe_free ((void *) name);
+        }
+      else if (!strcmp (*ext, "asm") || (!strcmp (*ext, "rel") && !noAssemble))
+        ok = FALSE;
+      Safe_free ((void *) from);
+    }
+
+  if (ok)
+    {
+      name = entryFile (dbuf_c_str (&tmpPath), CACHE_ERR_FILE);
+      rewind (errCopy);
+      ok = copyStream (errCopy, name);
+      Safe_free ((void *) name);
+    }
+  fclose (errCopy);
+  errCopy = NULL;
+
+  /* another compilation may have stored the same entry meanwhile */
+  if (!ok || rename (dbuf_c_str (&tmpPath), dbuf_c_str (&entryPath)))
+    removeEntry (dbuf_c_str (&tmpPath));
+  dbuf_destroy (&tmpPath);
+
+  trimCache ();
+}
@@ -0,0 +1,39 @@
+/*-------------------------------------------------------------------------
+  SDCCcache.h - cache of compiled modules (--cache-dir)
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#ifndef SDCCCACHE_H
+#define SDCCCACHE_H 1
+
+/** Called with --cache-dir once the preprocessor runs. Reads the
+ *  preprocessed source from yyin and replaces yyin with a copy of it.
+ *  Returns TRUE if the outputs were copied from the cache, then
+ *  nothing has to be compiled.
+ */
+bool cacheRestore (int argc, char **argv);
+
+/** Returns TRUE if cacheRestore () found no outputs and yyin is the
+ *  copy of the preprocessed source.
+ */
+bool cacheMiss (void);
+
+/** Stores the outputs of the compilation after a cache miss, unless
+ *  there were errors.
+ */
+void cacheStore (void);
+
+#endif
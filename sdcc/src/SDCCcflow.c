@@ -406,6 +406,8 @@ computeControlFlow (ebbIndex * ebbi)
   int dfCount = ebbi->count;
   int i;
 
+  timerBegin ("computeControlFlow");
+
   /* initialise some things */
 
   for (i = 0; i < ebbi->count; i++)
@@ -446,6 +448,7 @@ computeControlFlow (ebbIndex * ebbi)
       
   qsort (ebbi->dfOrder, ebbi->count, sizeof (eBBlock *), dfNumCompare);
 
+  timerEnd ("computeControlFlow");
 }
 
 /*-----------------------------------------------------------------*/
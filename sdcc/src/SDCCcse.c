@@ -37,7 +37,7 @@ newCseDef (operand * sym, iCode * ic)
   memmap *map;
 
   assert (sym);
-  cdp = Safe_alloc (sizeof (cseDef));
+  cdp = Func_alloc (sizeof (cseDef));
 
   cdp->sym = sym;
   cdp->diCode = ic;
@@ -2643,9 +2643,13 @@ cseAllBlocks (ebbIndex * ebbi, int computeOnly)
 
   /* if optimization turned off */
 
+  timerBegin ("cseAllBlocks");
+
   for (i = 0; i < count; i++)
     change += cseBBlock (ebbs[i], computeOnly, ebbi);
 
+  timerEnd ("cseAllBlocks");
+
   return change;
 }
 
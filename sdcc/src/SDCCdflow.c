@@ -170,12 +170,15 @@ computeDataFlow (ebbIndex * ebbi)
   int i;
   int change;
 
+  timerBegin ("computeDataFlow");
+
   for (i = 0; i < count; i++)
     ebbs[i]->killedExprs = NULL;
 
   do
     {
       change = 0;
+      timerAddCount ("computeDataFlow", 1);
 
       /* for all blocks */
       for (i = 0; i < count; i++)
@@ -254,6 +257,8 @@ computeDataFlow (ebbIndex * ebbi)
     }
   while (change);      /* iterate till no change */
 
+  timerEnd ("computeDataFlow");
+
   return;
 }
 
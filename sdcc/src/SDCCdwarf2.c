@@ -862,7 +862,7 @@ dwNewAttrAddrSymbol (int attr, symbol * sym, int offset)
 /*                      address of an assembler label plus an offset   */
 /*---------------------------------------------------------------------*/
 static dwattr *
-dwNewAttrAddrLabel (int attr, char * label, int offset)
+dwNewAttrAddrLabel (int attr, const char * label, int offset)
 {
   dwattr * ap;
   
@@ -340,7 +340,7 @@ typedef struct dwattr
   {
     struct
     {
-      char * label;
+      const char * label;
       int offset;
     } symaddr;
     struct
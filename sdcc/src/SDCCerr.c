@@ -20,6 +20,7 @@
 #include <stdlib.h>
 
 #include "SDCCerr.h"
+#include "dbuf_string.h"
 
 #define NELEM(x) (sizeof (x) / sizeof *(x))
 
@@ -541,6 +542,14 @@ struct
     "qualifier or static in array declarator that is not a parameter", 0},
   { E_STATIC_ARRAY_PARAM_C99, ERROR_LEVEL_ERROR,
     "static in array parameters requires ISO C99 or later", 0},
+  { E_OPT_O_WITH_SRC_FILES, ERROR_LEVEL_ERROR,
+    "cannot give an output file with -o and -c, -S or -E for several source files", 0},
+  { W_LTO_UNSUPPORTED, ERROR_LEVEL_WARNING,
+    "link-time optimization is not supported for port '%s', --lto ignored", 0},
+  { W_LTO_FAILED, ERROR_LEVEL_WARNING,
+    "link-time optimization failed, the modules are compiled separately", 0},
+  { E_LTO_PORT, ERROR_LEVEL_ERROR,
+    "'%s' was compiled with --lto for port '%s'", 0},
 };
 
 /* -------------------------------------------------------------------------------
@@ -555,6 +564,16 @@ SetErrorOut (FILE *NewErrorOut)
   return NewErrorOut;
 }
 
+/* -------------------------------------------------------------------------------
+ * SetErrorCopy - Set a file that gets a copy of the messages, NULL for none
+ * -------------------------------------------------------------------------------
+ */
+void
+SetErrorCopy (FILE *copy)
+{
+  _SDCCERRG.copy = copy;
+}
+
 /* -------------------------------------------------------------------------------
  * setErrorLogLevel - Set the error log level:
  *                    which level has to be treated as an error
@@ -592,53 +611,62 @@ vwerror (int errNum, va_list marker)
 
   if ((ErrTab[errNum].errType >= _SDCCERRG.logLevel) && (!ErrTab[errNum].disabled))
     {
+      struct dbuf_s msg;
+
       if (ErrTab[errNum].errType >= ERROR_LEVEL_ERROR || _SDCCERRG.werror)
         fatalError++;
 
+      dbuf_init (&msg, 128);
+
       if (filename && lineno)
         {
           if (_SDCCERRG.style)
-            fprintf (_SDCCERRG.out, "%s(%d) : ", filename, lineno);
+            dbuf_printf (&msg, "%s(%d) : ", filename, lineno);
           else
-            fprintf (_SDCCERRG.out, "%s:%d: ", filename, lineno);
+            dbuf_printf (&msg, "%s:%d: ", filename, lineno);
         }
       else if (lineno)
         {
-          fprintf (_SDCCERRG.out, "at %d: ", lineno);
+          dbuf_printf (&msg, "at %d: ", lineno);
         }
       else
         {
-          fprintf (_SDCCERRG.out, "-:0: ");
+          dbuf_printf (&msg, "-:0: ");
         }
 
       switch (ErrTab[errNum].errType)
         {
         case ERROR_LEVEL_SYNTAX_ERROR:
-          fprintf (_SDCCERRG.out, "syntax error: ");
+          dbuf_printf (&msg, "syntax error: ");
           break;
 
         case ERROR_LEVEL_ERROR:
-          fprintf (_SDCCERRG.out, "error %d: ", errNum);
+          dbuf_printf (&msg, "error %d: ", errNum);
           break;
 
         case ERROR_LEVEL_WARNING:
         case ERROR_LEVEL_PEDANTIC:
           if (_SDCCERRG.werror)
-            fprintf (_SDCCERRG.out, "error %d: ", errNum);
+            dbuf_printf (&msg, "error %d: ", errNum);
           else
-            fprintf (_SDCCERRG.out, "warning %d: ", errNum);
+            dbuf_printf (&msg, "warning %d: ", errNum);
           break;
 
         case ERROR_LEVEL_INFO:
-          fprintf (_SDCCERRG.out, "info %d: ", errNum);
+          dbuf_printf (&msg, "info %d: ", errNum);
           break;
 
         default:
           break;
         }
 
-      vfprintf (_SDCCERRG.out, ErrTab[errNum].errText, marker);
-      fprintf (_SDCCERRG.out, "\n");
+      dbuf_vprintf (&msg, ErrTab[errNum].errText, marker);
+      dbuf_append_char (&msg, '\n');
+
+      fputs (dbuf_c_str (&msg), _SDCCERRG.out);
+      if (_SDCCERRG.copy)
+        fputs (dbuf_c_str (&msg), _SDCCERRG.copy);
+      dbuf_destroy (&msg);
       return 1;
     }
   else
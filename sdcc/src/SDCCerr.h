@@ -269,6 +269,10 @@ enum {
   E_QUALIFIED_ARRAY_PARAM_C99   = 240, /* qualifiers in array parameters require ISO C99 or later */
   E_QUALIFIED_ARRAY_NOPARAM     = 241, /* qualifier or static in array declarator that is not a parameter */
   E_STATIC_ARRAY_PARAM_C99      = 242, /* static in array parameters requires ISO C99 or later */
+  E_OPT_O_WITH_SRC_FILES        = 243, /* -o file with -c, -S or -E and several source files */
+  W_LTO_UNSUPPORTED             = 244, /* --lto not supported by the port */
+  W_LTO_FAILED                  = 245, /* combined compilation failed, modules compiled separately */
+  E_LTO_PORT                    = 246, /* link-time optimization object for another port */
 
   /* don't touch this! */
   NUMBER_OF_ERROR_MESSAGES             /* Number of error messages */
@@ -310,6 +314,7 @@ typedef enum _ERROR_LOG_LEVEL ERROR_LOG_LEVEL;
 struct SDCCERRG {
   ERROR_LOG_LEVEL logLevel;
   FILE *out;
+  FILE *copy;                       /* gets a copy of the messages */
   int style;                        /* 1=MSVC */
   int werror;                       /* treat the warnings as errors */
 };
@@ -330,6 +335,14 @@ SetErrorOut - Set the error output file
 
 FILE * SetErrorOut (FILE *NewErrorOut);
 
+/*
+-------------------------------------------------------------------------------
+SetErrorCopy - Set a file that gets a copy of the messages, NULL for none
+-------------------------------------------------------------------------------
+*/
+
+void SetErrorCopy (FILE *copy);
+
 /*
 -------------------------------------------------------------------------------
 vwerror - Output a standard eror message with variable number of arguements
@@ -34,8 +34,8 @@ newLineNode (const char *line)
 {
   lineNode *pl;
 
-  pl = Safe_alloc (sizeof (lineNode));
-  pl->line = Safe_strdup (line);
+  pl = Func_alloc (sizeof (lineNode));
+  pl->line = Func_strdup (line);
   pl->ic = NULL;
   return pl;
 }
@@ -69,7 +69,8 @@ destroy_line_list (void)
     {
       lineNode *p;
 
-      if (pl->line)
+      /* inside a function the lines belong to the function arena */
+      if (pl->line && !inFuncAlloc ())
         Safe_free (pl->line);
 
       if (pl->aln)
@@ -77,7 +78,8 @@ destroy_line_list (void)
 
       p = pl;
       pl = pl->prev;
-      Safe_free (p);
+      if (!inFuncAlloc ())
+        Safe_free (p);
     }
   genLine.lineHead = genLine.lineCurr = NULL;
 }
@@ -90,7 +92,7 @@ add_line_node (const char *line)
 {
   lineNode *pl;
 
-  pl = Safe_alloc (sizeof (lineNode));
+  pl = Func_alloc (sizeof (lineNode));
 
 #if 1
   memcpy (pl, (lineElem_t *) & genLine.lineElement, sizeof (lineElem_t));
@@ -104,7 +106,7 @@ add_line_node (const char *line)
   pl->aln = genLine.lineElement.aln;
 #endif
 
-  pl->line = Safe_strdup (line);
+  pl->line = Func_strdup (line);
 
   if (genLine.lineCurr)
     {
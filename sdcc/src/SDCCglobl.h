@@ -352,8 +352,16 @@ struct options
     set *excludeRegsSet;        /* registers excluded from saving */
 /*  set *olaysSet;               * not implemented yet: overlay segments used in #pragma OVERLAY */
     int max_allocs_per_node;    /* Maximum number of allocations / combinations considered at each node in the tree-decomposition based algorithms */
+    char *use_profile;          /* execution counts recorded by the simulator, replace guessCounts () */
+    int max_allocs_time;        /* Time budget in ms per function for the tree-decomposition based algorithms, chooses max_allocs_per_node */
     bool noOptsdccInAsm;        /* Do not emit .optsdcc in asm */
     bool oldralloc;             /* Use old register allocator */
+    int mem_stats;              /* print memory arena statistics */
+    int time_report;            /* print compile time per pass and function */
+    char *time_trace;           /* write pass timings as Chrome trace to this file */
+    char *cache_dir;            /* directory of the compile cache */
+    int cache_size;             /* size limit of the compile cache in MiB */
+    int lto;                    /* link-time optimization of the whole program */
   };
 
 /* forward definition for variables accessed globally */
@@ -361,6 +369,7 @@ extern int noAssemble;          /* no assembly, stop after code generation */
 extern char *yytext;
 extern char *lexFilename;       /* lex idea of current file name */
 extern int lexLineno;           /* lex idea of line number of the current file */
+extern bool lexSystemHeader;    /* the current file is a system header */
 extern const char *fullSrcFileName; /* full name for the source file; */
                                 /* can be NULL while linking without compiling */
 extern const char *fullDstFileName; /* full name for the output file; */
@@ -243,8 +243,8 @@ emitRegularMap (memmap * map, bool addPublics, bool arFlag)
                  in the static seg */
               newSym = copySymbol (sym);
               SPEC_OCLS (newSym->etype) = (SPEC_OCLS (sym->etype) == xidata) ? xinit : initializer;
-              SNPRINTF (newSym->name, sizeof (newSym->name), "__xinit_%s", sym->name);
-              SNPRINTF (newSym->rname, sizeof (newSym->rname), "__xinit_%s", sym->rname);
+              newSym->name = internPrintf ("__xinit_%s", sym->name);
+              newSym->rname = internPrintf ("__xinit_%s", sym->rname);
 
               /* find the first non-array link */
               t = newSym->type;
@@ -1387,7 +1387,7 @@ void
 printIvalFuncPtr (sym_link * type, initList * ilist, struct dbuf_s *oBuf)
 {
   value *val;
-  char *name;
+  const char *name;
   int size;
 
   if (ilist)
@@ -2007,6 +2007,63 @@ flushStatics (void)
   statsg->syms = NULL;
 }
 
+/* Once the code segment holds this many bytes it is moved to a
+   temporary file, so that the code of a big module isn't kept in
+   memory until glue () writes it out. */
+#define CODE_SPILL_SIZE (1024 * 1024)
+
+static FILE *codeSpill;
+
+/*-----------------------------------------------------------------*/
+/* spillCode - move the code generated so far to a temporary file  */
+/*-----------------------------------------------------------------*/
+void
+spillCode (void)
+{
+  size_t len = dbuf_get_length (&code->oBuf);
+
+  /* ports with their own glue read the code segment themselves */
+  if (port->general.do_glue || len < CODE_SPILL_SIZE)
+    return;
+
+  /* without a temporary file the code just stays in memory */
+  if (!codeSpill && !(codeSpill = tmpfile ()))
+    return;
+
+  if (fwrite (dbuf_get_buf (&code->oBuf), 1, len, codeSpill) != len)
+    {
+      werror (E_TMPFILE_FAILED);
+      exit (EXIT_FAILURE);
+    }
+  dbuf_set_length (&code->oBuf, 0);
+}
+
+/*-----------------------------------------------------------------*/
+/* writeCode - write the spilled and the remaining code to afile   */
+/*-----------------------------------------------------------------*/
+static void
+writeCode (FILE * afile)
+{
+  if (codeSpill)
+    {
+      char *buf = Safe_alloc (CODE_SPILL_SIZE);
+      size_t len;
+
+      rewind (codeSpill);
+      while ((len = fread (buf, 1, CODE_SPILL_SIZE, codeSpill)) != 0)
+        fwrite (buf, 1, len, afile);
+      if (ferror (codeSpill))
+        {
+          werror (E_TMPFILE_FAILED);
+          exit (EXIT_FAILURE);
+        }
+      Safe_free (buf);
+      fclose (codeSpill);
+      codeSpill = NULL;
+    }
+  dbuf_write_and_destroy (&code->oBuf, afile);
+}
+
 /*-----------------------------------------------------------------*/
 /* createInterruptVect - creates the interrupt vector              */
 /*-----------------------------------------------------------------*/
@@ -2558,7 +2615,7 @@ glue (void)
   fprintf (asmFile, "; code\n");
   fprintf (asmFile, "%s", iComments2);
   tfprintf (asmFile, "\t!areacode\n", options.code_seg);
-  dbuf_write_and_destroy (&code->oBuf, asmFile);
+  writeCode (asmFile);
 
   if (port->genAssemblerEnd)
     {
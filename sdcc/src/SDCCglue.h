@@ -32,6 +32,7 @@ void glue (void);
    This is needed in gen.c of z80 port */
 char *aopLiteral (value *, int);
 void flushStatics (void);
+void spillCode (void);
 int printIvalCharPtr (symbol *, sym_link *, value *, struct dbuf_s *);
 
 extern symbol *interrupts[];
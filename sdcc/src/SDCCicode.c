@@ -546,7 +546,7 @@ newOperand ()
 {
   operand *op;
 
-  op = Safe_alloc (sizeof (operand));
+  op = Func_alloc (sizeof (operand));
 
   op->key = 0;
   return op;
@@ -560,7 +560,7 @@ newiCode (int op, operand * left, operand * right)
 {
   iCode *ic;
 
-  ic = Safe_alloc (sizeof (iCode));
+  ic = Func_alloc (sizeof (iCode));
 
   ic->seqPoint = seqPoint;
   ic->filename = filename;
@@ -629,7 +629,7 @@ newiTemp (const char *s)
 
   itmp = newSymbol (dbuf_c_str (&dbuf), 1);
   dbuf_destroy (&dbuf);
-  strncpyz (itmp->rname, itmp->name, SDCC_NAME_MAX);
+  itmp->rname = itmp->name;
   itmp->isitmp = 1;
 
   return itmp;
@@ -800,6 +800,20 @@ newiTempOperand (sym_link * type, char throwType)
   return op;
 }
 
+/*-----------------------------------------------------------------*/
+/* newiTempReqvOperand - temp operand for a register equivalent;   */
+/*   outlives the function since the debug information written at  */
+/*   glue time still refers to it                                  */
+/*-----------------------------------------------------------------*/
+static operand *
+newiTempReqvOperand (sym_link * type)
+{
+  operand *op = Global_alloc (sizeof (operand));
+
+  *op = *newiTempOperand (type, 0);
+  return op;
+}
+
 /*-----------------------------------------------------------------*/
 /* operandType - returns the type chain for an operand             */
 /*-----------------------------------------------------------------*/
@@ -1676,7 +1690,7 @@ operandFromSymbol (symbol * sym)
     {
       /* we will use it after all optimizations
          and before liveRange calculation */
-      sym->reqv = newiTempOperand (sym->type, 0);
+      sym->reqv = newiTempReqvOperand (sym->type);
       sym->reqv->key = sym->key;
       OP_SYMBOL (sym->reqv)->prereqv = sym;
       OP_SYMBOL (sym->reqv)->key = sym->key;
@@ -3583,7 +3597,7 @@ geniCodeReceive (value * args, operand * func)
                 }
               else
                 {
-                  opl = newiTempOperand (args->type, 0);
+                  opl = newiTempReqvOperand (args->type);
                   sym->reqv = opl;
                   sym->reqv->key = sym->key;
                   OP_SYMBOL (sym->reqv)->key = sym->key;
@@ -3792,7 +3806,8 @@ geniCodeJumpTable (operand * cond, value * caseVals, ast * tree)
   maxVal = vch;
 
   /* Exit if the range is too large to handle with a jump table. */
-  if (1 + max - min > port->jumptableCost.maxCount)
+  /* The difference may not fit an int, e.g. for case 0x7fffffff. */
+  if (1 + (long long) max - min > port->jumptableCost.maxCount)
     return 0;
 
   switch (getSize (operandType (cond)))
@@ -3935,6 +3950,280 @@ geniCodeJumpTable (operand * cond, value * caseVals, ast * tree)
   return 1;
 }
 
+/* A run of consecutive case values that geniCodeSwitchClusters () */
+/* dispatches as a unit: a single compare or a jump table.          */
+typedef struct swCluster
+{
+  value *first;                 /* first case value of the cluster */
+  int count;                    /* number of case values */
+  long long min, max;           /* first and last case value */
+}
+swCluster;
+
+/* Below this many clusters a binary tree saves no compares */
+#define SWITCH_TREE_MIN 4
+
+/*-----------------------------------------------------------------*/
+/* switchCaseLabel - the label of a case of a switch               */
+/*-----------------------------------------------------------------*/
+static symbol *
+switchCaseLabel (ast * tree, long long val)
+{
+  struct dbuf_s dbuf;
+  symbol *label;
+
+  dbuf_init (&dbuf, 128);
+  dbuf_printf (&dbuf, "_case_%d_%d%s", tree->values.switchVals.swNum, (int) val,
+               tree->values.switchVals.swSuffix ? tree->values.switchVals.swSuffix : "");
+  label = newiTempLabel (dbuf_c_str (&dbuf));
+  dbuf_destroy (&dbuf);
+
+  return label;
+}
+
+/*-----------------------------------------------------------------*/
+/* switchDefaultLabel - the label for values without a case        */
+/*-----------------------------------------------------------------*/
+static symbol *
+switchDefaultLabel (ast * tree)
+{
+  struct dbuf_s dbuf;
+  symbol *label;
+
+  dbuf_init (&dbuf, 128);
+  dbuf_printf (&dbuf, tree->values.switchVals.swDefault ? "_default_%d%s" : "_swBrk_%d%s", tree->values.switchVals.swNum,
+               tree->values.switchVals.swSuffix ? tree->values.switchVals.swSuffix : "");
+  label = newiTempLabel (dbuf_c_str (&dbuf));
+  dbuf_destroy (&dbuf);
+
+  return label;
+}
+
+/*-----------------------------------------------------------------*/
+/* geniCodeSwitchCompare - jumps to label if cond op val           */
+/*-----------------------------------------------------------------*/
+static void
+geniCodeSwitchCompare (operand * cond, int op, long long val, symbol * label)
+{
+  sym_link *cetype = getSpec (operandType (cond));
+  operand *lit = operandFromValue (valCastLiteral (cetype, val, val));
+
+  ADDTOCHAIN (newiCodeCondition (geniCodeLogic (cond, lit, op, NULL), label, NULL));
+}
+
+/*-----------------------------------------------------------------*/
+/* geniCodeClusterTable - a jump table for the values of a cluster */
+/*   Values below the cluster go to lowLabel, above it to          */
+/*   highLabel. lo and hi are the known bounds of cond.            */
+/*-----------------------------------------------------------------*/
+static void
+geniCodeClusterTable (operand * cond, swCluster * c, ast * tree, symbol * lowLabel, symbol * highLabel, long long lo, long long hi)
+{
+  symbol *falseLabel = switchDefaultLabel (tree);
+  set *labels = NULL;
+  value *vch = c->first;
+  iCode *ic;
+  long long i;
+
+  for (i = c->min; i <= c->max; i++)
+    if ((int) ulFromVal (vch) == i)
+      {
+        addSet (&labels, switchCaseLabel (tree, i));
+        vch = vch->next;
+      }
+    else
+      addSet (&labels, falseLabel);
+
+  if (lo < c->min)
+    geniCodeSwitchCompare (cond, '<', c->min, lowLabel);
+  if (hi > c->max)
+    geniCodeSwitchCompare (cond, '>', c->max, highLabel);
+
+  if (c->min)
+    {
+      cond = geniCodeSubtract (cond, operandFromLit (c->min), RESULT_TYPE_CHAR);
+      if (!IS_LITERAL (getSpec (operandType (cond))))
+        setOperandType (cond, UCHARTYPE);
+    }
+
+  ic = newiCode (JUMPTABLE, NULL, NULL);
+  IC_JTCOND (ic) = cond;
+  IC_JTLABELS (ic) = labels;
+  ADDTOCHAIN (ic);
+}
+
+/*-----------------------------------------------------------------*/
+/* geniCodeSwitchChain - tests the clusters one after the other    */
+/*-----------------------------------------------------------------*/
+static void
+geniCodeSwitchChain (operand * cond, swCluster * clusters, int first, int last, ast * tree, long long lo, long long hi)
+{
+  int i;
+
+  for (i = first; i <= last; i++)
+    {
+      swCluster *c = &clusters[i];
+
+      if (c->count == 1 && lo == c->min && hi == c->min)
+        geniCodeGoto (switchCaseLabel (tree, c->min));
+      else if (c->count == 1)
+        geniCodeSwitchCompare (cond, EQ_OP, c->min, switchCaseLabel (tree, c->min));
+      else
+        {
+          /* the later clusters are all above this one */
+          symbol *next = newiTempLabel (NULL);
+
+          geniCodeClusterTable (cond, c, tree, switchDefaultLabel (tree), next, lo, hi);
+          geniCodeLabel (next);
+          lo = c->max + 1;
+        }
+    }
+  geniCodeGoto (switchDefaultLabel (tree));
+}
+
+/*-----------------------------------------------------------------*/
+/* geniCodeSwitchTree - a balanced binary search for the cluster   */
+/*-----------------------------------------------------------------*/
+static void
+geniCodeSwitchTree (operand * cond, swCluster * clusters, int first, int last, ast * tree, long long lo, long long hi)
+{
+  symbol *lowerLabel;
+  int mid;
+
+  if (last - first + 1 < SWITCH_TREE_MIN)
+    {
+      geniCodeSwitchChain (cond, clusters, first, last, tree, lo, hi);
+      return;
+    }
+
+  mid = first + (last - first + 1) / 2;
+  lowerLabel = newiTempLabel (NULL);
+  geniCodeSwitchCompare (cond, '<', clusters[mid].min, lowerLabel);
+  geniCodeSwitchTree (cond, clusters, mid, last, tree, clusters[mid].min, hi);
+  geniCodeLabel (lowerLabel);
+  geniCodeSwitchTree (cond, clusters, first, mid - 1, tree, lo, clusters[mid].min - 1);
+}
+
+/*-----------------------------------------------------------------*/
+/* geniCodeSwitchClusters - splits the case values into clusters   */
+/*   that are dense enough for a jump table each, when a single    */
+/*   jump table for all of them is too sparse. The clusters are    */
+/*   tested one after the other, or with --opt-code-speed by a     */
+/*   binary search. Returns 0 if a plain compare for each case is  */
+/*   at least as good.                                             */
+/*-----------------------------------------------------------------*/
+static int
+geniCodeSwitchClusters (operand * cond, value * caseVals, ast * tree)
+{
+  sym_link *cetype = getSpec (operandType (cond));
+  int size = getSize (operandType (cond));
+  bool speed = optimize.codeSpeed && !optimize.codeSize;
+  int sizeIndex, sizeofMatchJump, n, k, tables, i, j;
+  long long typeMin, typeMax;
+  value **vals, *vch;
+  int *best, *from;
+  swCluster *clusters;
+
+  switch (size)
+    {
+    case 1:
+      sizeIndex = 0;
+      break;
+    case 2:
+      sizeIndex = 1;
+      break;
+    case 4:
+      sizeIndex = 2;
+      break;
+    default:
+      return 0;
+    }
+  sizeofMatchJump = port->jumptableCost.sizeofMatchJump[sizeIndex];
+
+  /* The cases are sorted as int. Give up on values that cond can't */
+  /* hold, they would need the compares of the type in that order.  */
+  if (IS_UNSIGNED (cetype))
+    {
+      typeMin = 0;
+      typeMax = size == 4 ? 0x7fffffffLL : (1LL << (size * 8)) - 1;
+    }
+  else
+    {
+      typeMin = -(1LL << (size * 8 - 1));
+      typeMax = (1LL << (size * 8 - 1)) - 1;
+    }
+
+  for (n = 0, vch = caseVals; vch; vch = vch->next, n++)
+    if ((int) ulFromVal (vch) < typeMin || (int) ulFromVal (vch) > typeMax)
+      return 0;
+  if (n < 3)
+    return 0;
+  if (IS_UNSIGNED (cetype) && size == 4)
+    typeMax = 0xffffffffLL;
+
+  vals = Safe_alloc (n * sizeof (value *));
+  for (i = 0, vch = caseVals; vch; vch = vch->next, i++)
+    vals[i] = vch;
+
+  /* best[j] is the smallest size of the first j case values split */
+  /* into clusters, from[j] the first value of the last cluster    */
+  best = Safe_alloc ((n + 1) * sizeof (int));
+  from = Safe_alloc ((n + 1) * sizeof (int));
+  for (j = 1; j <= n; j++)
+    {
+      long long max = (int) ulFromVal (vals[j - 1]);
+
+      best[j] = best[j - 1] + sizeofMatchJump;
+      from[j] = j - 1;
+      for (i = j - 2; i >= 0; i--)
+        {
+          long long min = (int) ulFromVal (vals[i]);
+          int cost;
+
+          if (max - min + 1 > port->jumptableCost.maxCount)
+            break;
+          cost = (max - min + 1) * port->jumptableCost.sizeofElement + port->jumptableCost.sizeofDispatch +
+            2 * port->jumptableCost.sizeofRangeCompare[sizeIndex] + (min ? port->jumptableCost.sizeofSubtract : 0);
+          if (best[i] + cost < best[j])
+            {
+              best[j] = best[i] + cost;
+              from[j] = i;
+            }
+        }
+    }
+
+  for (k = 0, j = n; j > 0; j = from[j])
+    k++;
+  clusters = Safe_alloc (k * sizeof (swCluster));
+  for (tables = 0, i = k, j = n; j > 0; j = from[j])
+    {
+      swCluster *c = &clusters[--i];
+
+      c->first = vals[from[j]];
+      c->count = j - from[j];
+      c->min = (int) ulFromVal (vals[from[j]]);
+      c->max = (int) ulFromVal (vals[j - 1]);
+      if (c->count > 1)
+        tables++;
+    }
+
+  /* Without jump tables the chain is the plain compares. Only with */
+  /* --opt-code-speed a binary search pays for its extra compares.  */
+  if (speed ? k < SWITCH_TREE_MIN && !tables : !tables)
+    k = 0;
+  else if (speed)
+    geniCodeSwitchTree (cond, clusters, 0, k - 1, tree, typeMin, typeMax);
+  else
+    geniCodeSwitchChain (cond, clusters, 0, k - 1, tree, typeMin, typeMax);
+
+  Safe_free (clusters);
+  Safe_free (from);
+  Safe_free (best);
+  Safe_free (vals);
+
+  return k != 0;
+}
+
 /*-----------------------------------------------------------------*/
 /* geniCodeSwitch - changes a switch to a if statement             */
 /*-----------------------------------------------------------------*/
@@ -3994,6 +4283,10 @@ geniCodeSwitch (ast * tree, int lvl)
   if (geniCodeJumpTable (cond, caseVals, tree))
     goto jumpTable;             /* no need for the comparison */
 
+  /* or jump tables for parts of the range */
+  if (geniCodeSwitchClusters (cond, caseVals, tree))
+    goto jumpTable;
+
   /* for the cases defined do */
   while (caseVals)
     {
@@ -38,7 +38,7 @@ newInduction (operand * sym, unsigned int op, long constVal, iCode * ic, operand
 {
   induction *ip;
 
-  ip = Safe_alloc (sizeof (induction));
+  ip = Func_alloc (sizeof (induction));
 
   ip->sym = sym;
   ip->asym = asym;
@@ -57,7 +57,7 @@ newRegion ()
 {
   region *lp;
 
-  lp = Safe_alloc (sizeof (region));
+  lp = Func_alloc (sizeof (region));
 
   return lp;
 }
@@ -1407,6 +1407,8 @@ loopOptimizations (hTab * orderedLoops, ebbIndex * ebbi)
   if (!optimize.loopInvariant && !optimize.loopInduction)
     return 0;
 
+  timerBegin ("loopOptimizations");
+
   /* now we process the loops inner to outer order */
   /* this is essential to maintain data flow information */
   /* the other choice is an ugly iteration for the depth */
@@ -1421,5 +1423,7 @@ loopOptimizations (hTab * orderedLoops, ebbIndex * ebbi)
         change += loopInduction (lp, ebbi);
     }
 
+  timerEnd ("loopOptimizations");
+
   return change;
 }
@@ -23,6 +23,16 @@
 
 #include "SDCClospre.hpp"
 
+// The cost of inserting a calculation on the edge from ic to next. With --opt-code-speed it is weighted by how often the edge is taken, which is at most the execution count of either end.
+static float
+edge_cost (float size, const iCode *ic, const iCode *next)
+{
+  if (!optimize.codeSpeed || optimize.codeSize)
+    return (size);
+
+  return (size * (1.0f + (ic->count < next->count ? ic->count : next->count)));
+}
+
 // A quick-and-dirty function to get the CFG from sdcc (a simplified version of the function from SDCCralloc.hpp).
 void
 create_cfg_lospre (cfg_lospre_t &cfg, iCode *start_ic, ebbIndex *ebbi)
@@ -45,19 +55,19 @@ create_cfg_lospre (cfg_lospre_t &cfg, iCode *start_ic, ebbIndex *ebbi)
   for (ic = start_ic; ic; ic = ic->next)
     {
       if((ic->op == '>' || ic->op == '<' || ic->op == LE_OP || ic->op == GE_OP || ic->op == EQ_OP || ic->op == NE_OP || ic->op == '^' || ic->op == '|' || ic->op == BITWISEAND) && ifxForOp (IC_RESULT (ic), ic))
-        boost::add_edge(key_to_index[ic->key], key_to_index[ic->next->key], 4.0f, cfg); // Try not to separate op from ifx.
+        boost::add_edge(key_to_index[ic->key], key_to_index[ic->next->key], edge_cost (4.0f, ic, ic->next), cfg); // Try not to separate op from ifx.
       else if (ic->op != GOTO && ic->op != RETURN && ic->op != JUMPTABLE && ic->next)
-        boost::add_edge(key_to_index[ic->key], key_to_index[ic->next->key], 3.0f, cfg);
+        boost::add_edge(key_to_index[ic->key], key_to_index[ic->next->key], edge_cost (3.0f, ic, ic->next), cfg);
 
       if (ic->op == GOTO)
-        boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, ic->label)->sch->key], 6.0f, cfg);
+        boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, ic->label)->sch->key], edge_cost (6.0f, ic, eBBWithEntryLabel(ebbi, ic->label)->sch), cfg);
       else if (ic->op == RETURN)
-        boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, returnLabel)->sch->key], 6.0f, cfg);
+        boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, returnLabel)->sch->key], edge_cost (6.0f, ic, eBBWithEntryLabel(ebbi, returnLabel)->sch), cfg);
       else if (ic->op == IFX)
-        boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, IC_TRUE(ic) ? IC_TRUE(ic) : IC_FALSE(ic))->sch->key], 6.0f, cfg);
+        boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, IC_TRUE(ic) ? IC_TRUE(ic) : IC_FALSE(ic))->sch->key], edge_cost (6.0f, ic, eBBWithEntryLabel(ebbi, IC_TRUE(ic) ? IC_TRUE(ic) : IC_FALSE(ic))->sch), cfg);
       else if (ic->op == JUMPTABLE)
         for (symbol *lbl = (symbol *)(setFirstItem (IC_JTLABELS (ic))); lbl; lbl = (symbol *)(setNextItem (IC_JTLABELS (ic))))
-          boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, lbl)->sch->key], 6.0f, cfg);
+          boost::add_edge(key_to_index[ic->key], key_to_index[eBBWithEntryLabel(ebbi, lbl)->sch->key], edge_cost (6.0f, ic, eBBWithEntryLabel(ebbi, lbl)->sch), cfg);
     }
 }
 
@@ -305,6 +315,8 @@ lospre (iCode *sic, ebbIndex *ebbi)
 
   int lkey = operandKey;
 
+  static allocs_budget budget ("lospre", 0.25, 2000000);
+
   for (bool change = true; change;)
     {
       change = false;
@@ -312,6 +324,8 @@ lospre (iCode *sic, ebbIndex *ebbi)
       std::set<int> candidate_set;
       get_candidate_set (&candidate_set, sic, lkey);
 
+      budget.begin (tree_decomposition, candidate_set.size ());
+
       std::set<int>::iterator ci, ci_end;
       for (ci = candidate_set.begin(), ci_end = candidate_set.end(); ci != ci_end; ++ci)
         {
@@ -328,6 +342,8 @@ lospre (iCode *sic, ebbIndex *ebbi)
 
           change |= (tree_dec_lospre (tree_decomposition, control_flow_graph, ic) > 0);
         }
+
+      budget.end ();
     }
 }
 
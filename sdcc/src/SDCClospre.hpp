@@ -30,6 +30,7 @@
 #include <boost/tuple/tuple_comparison.hpp>
 
 #include "SDCCtree_dec.hpp"
+#include "SDCCbudget.hpp"
 
 extern "C"
 {
@@ -115,7 +116,7 @@ struct tree_dec_lospre_node
   unsigned weight; // The weight is the number of nodes at which intermediate results need to be remembered. In general, to minimize memory consumption, at join nodes the child with maximum weight should be processed first.
 };
 
-typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, cfg_lospre_node, float> cfg_lospre_t; // The edge property is the cost of subdividing the edge and inserting an instruction (for now we always use 1, optimizing for code size, but relative execution frequency could be used when optimizing for speed or total energy consumption; aggregates thereof can be a good idea as well).
+typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, cfg_lospre_node, float> cfg_lospre_t; // The edge property is the cost of subdividing the edge and inserting an instruction (code size, weighted by the execution frequency with --opt-code-speed; aggregates, e.g. for total energy consumption, can be a good idea as well).
 typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, tree_dec_lospre_node> tree_dec_lospre_t;
 
 #ifdef DEBUG_LOSPRE
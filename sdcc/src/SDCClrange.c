@@ -190,135 +190,6 @@ markAlive (iCode * sic, iCode * eic, int key)
     }
 }
 
-/*-----------------------------------------------------------------*/
-/* findNextUseSym - finds the next use of the symbol and marks it  */
-/*                  alive in between                               */
-/*                  Return 0 iff there is no next use.             */
-/*-----------------------------------------------------------------*/
-static int
-findNextUseSym (eBBlock *ebp, iCode *ic, symbol * sym)
-{
-  int retval = 0;
-  iCode *uic;
-  eBBlock *succ;
-
-  hTabAddItemIfNotP (&liveRanges, sym->key, sym);
-
-  if (!ic)
-    goto check_successors;
-
-  /* if we check a complete block and the symbol */
-  /* is alive at the beginning of the block */
-  /* and not defined in the first instructions */
-  /* then a next use exists (return 1) */
-  if ((ic == ebp->sch) && bitVectBitValue(ic->rlive, sym->key))
-    {
-      /* check if the first instruction is a def of this op */
-      if (ic->op == JUMPTABLE || ic->op == IFX || SKIP_IC2(ic))
-        return 1;
-
-      if (IS_ITEMP(IC_RESULT(ic)))
-        if (IC_RESULT(ic)->key == sym->key)
-          return 0;
-
-      return 1;
-    }
-
-  if (ebp->visited)
-    return 0;
-
-  if (ic == ebp->sch)
-    ebp->visited = 1;
-
-  /* for all remaining instructions in current block */
-  for (uic = ic; uic; uic = uic->next)
-    {
-
-      if (SKIP_IC2(uic))
-        continue;
-
-      if (uic->op == JUMPTABLE)
-        {
-          if (IS_ITEMP(IC_JTCOND(uic)) && IC_JTCOND(uic)->key == sym->key)
-            {
-	      markAlive(ic, uic, sym->key);
-	      return 1;
-	    }
-	   continue;
-	}
-
-      if (uic->op == IFX)
-        {
-          if (IS_ITEMP(IC_COND(uic)) && IC_COND(uic)->key == sym->key)
-            {
-	      markAlive(ic, uic, sym->key);
-	      return 1;
-	    }
-	   continue;
-	}
-
-      if (IS_ITEMP (IC_LEFT (uic)))
-        if (IC_LEFT (uic)->key == sym->key)
-          {
-	    markAlive(ic, uic, sym->key);
-	    return 1;
-	  }
-
-      if (IS_ITEMP (IC_RIGHT (uic)))
-        if (IC_RIGHT (uic)->key == sym->key)
-	  {
-	    markAlive (ic, uic, sym->key);
-	    return 1;
-	  }
-
-      if (IS_ITEMP (IC_RESULT (uic)))
-        if (IC_RESULT (uic)->key == sym->key)
-	  {
-	    if (POINTER_SET (uic))
-	      {
-	        markAlive (ic, uic, sym->key);
-                return 1;
-	      }
-	    else
-	      return 0;
-	  }
-
-    }
-
-  /* check all successors */
-check_successors:
-
-  succ = setFirstItem (ebp->succList);
-  for (; succ; succ = setNextItem (ebp->succList))
-    {
-      retval += findNextUseSym (succ, succ->sch, sym);
-    }
-
-  if (retval)
-    {
-      if (ic) markAlive (ic, ebp->ech, sym->key);
-      return 1;
-    }
-
-  return 0;
-}
-
-/*-----------------------------------------------------------------*/
-/* findNextUse - finds the next use of the operand and marks it    */
-/*               alive in between                                  */
-/*               Return 0 iff there is no next use.                */
-/*-----------------------------------------------------------------*/
-static int
-findNextUse (eBBlock *ebp, iCode *ic, operand *op)
-{
-  if (op->isaddr)
-    OP_SYMBOL (op)->isptr = 1;
-
-  OP_SYMBOL (op)->key = op->key;
-
-  return findNextUseSym (ebp, ic, OP_SYMBOL(op));
-}
-
 /*-----------------------------------------------------------------*/
 /* unvisitBlocks - clears visited in all blocks                    */
 /*-----------------------------------------------------------------*/
@@ -371,316 +242,577 @@ markWholeLoop (eBBlock *ebp, int key)
   markAlive (ebp->sch, ebp->ech, key);
 }
 
-/*------------------------------------------------------------------*/
-/* findPrevUseSym - search for a previous definition of a symbol in */
-/*                  - the previous icodes                           */
-/*                  - all branches of predecessors                  */
-/*------------------------------------------------------------------*/
-static bool
-findPrevUseSym  (eBBlock *ebp, iCode *ic, symbol * sym)
+
+/*-----------------------------------------------------------------*/
+/* incUsed - increment a symbol's usage count                      */
+/*-----------------------------------------------------------------*/
+static void
+incUsed (iCode *ic, operand *op)
 {
-  eBBlock * pred;
-  iCode * uic;
+  if (ic->depth)
+    OP_SYMBOL (op)->used += (((unsigned int) 1 << ic->depth) + 1);
+  else
+    OP_SYMBOL (op)->used += 1;
+}
+
+/*-----------------------------------------------------------------*/
+/* rliveClear - clears the rlive bitVectors                        */
+/*-----------------------------------------------------------------*/
+static void
+rliveClear (eBBlock **ebbs, int count)
+{
+  int i;
 
-  if (ebp->visited)
+  /* for all blocks do */
+  for (i = 0; i < count; i++)
     {
-     /* already visited: this branch must have been succesfull, */
-     /* because otherwise the search would have been aborted. */
-      return TRUE;
+      iCode *ic;
+
+      /* for all instructions in this block do */
+      for (ic = ebbs[i]->sch; ic; ic = ic->next)
+        {
+	      freeBitVect (ic->rlive);
+	      ic->rlive = NULL;
+	    }
     }
-  ebp->visited = 1;
+}
+
+
+/*-----------------------------------------------------------------*/
+/* lrBlock - per block sets of the liveness data flow problems,    */
+/*           all indexed by operand key                            */
+/*-----------------------------------------------------------------*/
+typedef struct lrBlock
+{
+  eBBlock *ebp;                 /* the block                               */
+  set *preds;                   /* all predecessors, including back edges  */
+  bitVect *use;                 /* iTemps used before defined in the block */
+  bitVect *def;                 /* iTemps defined in the block             */
+  bitVect *seen;                /* iTemps used or defined in the block     */
+  bitVect *autoDef;             /* autosyms defined in the block           */
+  bitVect *liveIn;              /* iTemps alive at the block entry         */
+  bitVect *liveOut;             /* iTemps alive at the block exit          */
+  bitVect *seenIn;              /* iTemps used or defined on a path to the entry */
+  bitVect *undefIn;             /* autosyms not defined on some path to the entry */
+  unsigned int onList:1;        /* is on the work list                     */
+}
+lrBlock;
+
+/*-----------------------------------------------------------------*/
+/* lrNewSet - creates an empty set that can hold every operand key */
+/* bitVectUnion () sizes its result after the first argument, so   */
+/* all sets are created large enough for the highest key up front  */
+/*-----------------------------------------------------------------*/
+static bitVect *
+lrNewSet (void)
+{
+  return newBitVect (operandKey + 1);
+}
+
+/*-----------------------------------------------------------------*/
+/* lrIndex - maps the bbnum of a block to its lrBlock, -1 if none  */
+/*-----------------------------------------------------------------*/
+static int *lrIndex;
+static int lrIndexSize;
+
+static lrBlock *
+lrBlockOf (lrBlock *lrbs, eBBlock *ebp)
+{
+  if (!ebp || ebp->bbnum < 0 || ebp->bbnum >= lrIndexSize || lrIndex[ebp->bbnum] < 0)
+    return NULL;
+  return &lrbs[lrIndex[ebp->bbnum]];
+}
+
+/*-----------------------------------------------------------------*/
+/* icLiveOperands - returns the operands read by ic and sets *def  */
+/*                  to the operand it writes                       */
+/*-----------------------------------------------------------------*/
+static int
+icLiveOperands (iCode *ic, operand **uses, operand **def)
+{
+  int n = 0;
+
+  *def = NULL;
 
-  /* search backward in the current block */
-  for (uic = ic; uic; uic = uic->prev)
+  if (SKIP_IC2 (ic))
+    return 0;
+
+  if (ic->op == JUMPTABLE)
     {
-      if (!POINTER_SET (uic) && IS_AUTOSYM (IC_RESULT (uic)))
-        {
-          if (IC_RESULT (uic)->key == sym->key)
-            {
-              /* Ok, found a definition */
-              return TRUE;
-            }
-        }
-      /* address taken from symbol? */
-      if (uic->op == ADDRESS_OF && IS_AUTOSYM (IC_LEFT (uic)))
-        {
-          if (IC_LEFT (uic)->key == sym->key)
-            {
-              /* Ok, found a definition */
-              return TRUE;
-            }
-        }
+      if (IS_SYMOP (IC_JTCOND (ic)))
+        uses[n++] = IC_JTCOND (ic);
+      return n;
     }
 
-  /* There's no definition in this bblock, */
-  /* let's have a look at all predecessors. */
-  pred = setFirstItem (ebp->predList);
-  if (!pred)
+  if (ic->op == IFX)
     {
-      /* no more predecessors and nothing found yet :-( */
-      return FALSE;
+      if (IS_SYMOP (IC_COND (ic)))
+        uses[n++] = IC_COND (ic);
+      return n;
     }
-  for (; pred; pred = setNextItem (ebp->predList))
+
+  if (IS_SYMOP (IC_LEFT (ic)))
+    uses[n++] = IC_LEFT (ic);
+  if (IS_SYMOP (IC_RIGHT (ic)))
+    uses[n++] = IC_RIGHT (ic);
+  if (IS_SYMOP (IC_RESULT (ic)))
     {
-      /* recurse into all predecessors */
-      if (!findPrevUseSym (pred, pred->ech, sym))
-        {
-          /* found nothing: abort */
-          return FALSE;
-        }
+      if (POINTER_SET (ic))
+        uses[n++] = IC_RESULT (ic);
+      else
+        *def = IC_RESULT (ic);
     }
 
-  /* Success! Went through all branches with no abort: */
-  /* all branches end with a definition */
-  return TRUE;
+  return n;
 }
 
-/*------------------------------------------------------------------*/
-/* findPrevUse - search for a previous definition of an operand     */
-/*                  If there's no definition let's:                 */
-/*                  - emit a warning                                */
-/*                  - fix the life range, if the symbol is used in  */
-/*                    a loop                                        */
-/*------------------------------------------------------------------*/
+/*-----------------------------------------------------------------*/
+/* touchLiveOperand - bookkeeping for an operand taking part in    */
+/*                    the live range computation                   */
+/*-----------------------------------------------------------------*/
 static void
-findPrevUse (eBBlock *ebp, iCode *ic, operand *op,
-             eBBlock ** ebbs, int count,
-             bool emitWarnings)
+touchLiveOperand (operand *op)
 {
-  unvisitBlocks (ebbs, count);
-
   if (op->isaddr)
     OP_SYMBOL (op)->isptr = 1;
+
   OP_SYMBOL (op)->key = op->key;
 
-  /* There must be a definition in each branch of predecessors */
-  if (!findPrevUseSym (ebp, ic->prev, OP_SYMBOL(op)))
+  if (IS_ITEMP (op))
+    hTabAddItemIfNotP (&liveRanges, op->key, OP_SYMBOL (op));
+}
+
+/*-----------------------------------------------------------------*/
+/* lrLocalSets - computes the local sets of a block, usage counts  */
+/*               and def keys                                      */
+/*-----------------------------------------------------------------*/
+static void
+lrLocalSets (lrBlock *lrb, bitVect **allAutos)
+{
+  iCode *ic;
+  operand *uses[3], *def;
+  int n, j;
+
+  lrb->use = lrNewSet ();
+  lrb->def = lrNewSet ();
+  lrb->seen = lrNewSet ();
+  lrb->autoDef = lrNewSet ();
+
+  for (ic = lrb->ebp->sch; ic; ic = ic->next)
     {
-      /* computeLiveRanges() is called at least twice */
-      if (emitWarnings)
+      n = icLiveOperands (ic, uses, &def);
+
+      for (j = 0; j < n; j++)
         {
+          operand *op = uses[j];
+
+          incUsed (ic, op);
+
+          /* taking the address does not read the variable */
+          if (IS_AUTOSYM (op) && !(ic->op == ADDRESS_OF && op == IC_LEFT (ic)))
+            *allAutos = bitVectSetBit (*allAutos, op->key);
+
+          if (!IS_AUTOSYM (op))
+            continue;
+
+          touchLiveOperand (op);
           if (IS_ITEMP (op))
             {
-              if (OP_SYMBOL (op)->prereqv)
-                {
-                  werrorfl (ic->filename, ic->lineno, W_LOCAL_NOINIT,
-                            OP_SYMBOL (op)->prereqv->name);
-                  OP_SYMBOL (op)->prereqv->reqv = NULL;
-                  OP_SYMBOL (op)->prereqv->allocreq = 1;
-                }
-            }
-          else
-            {
-              werrorfl (ic->filename, ic->lineno, W_LOCAL_NOINIT,
-                        OP_SYMBOL (op)->name);
+              if (!bitVectBitValue (lrb->def, op->key))
+                lrb->use = bitVectSetBit (lrb->use, op->key);
+              lrb->seen = bitVectSetBit (lrb->seen, op->key);
             }
         }
-      /* is this block part of a loop? */
-      if (IS_ITEMP (op) && ebp->depth != 0)
+
+      if (ic->op == ADDRESS_OF && IS_AUTOSYM (IC_LEFT (ic)))
+        lrb->autoDef = bitVectSetBit (lrb->autoDef, IC_LEFT (ic)->key);
+
+      if (def)
         {
-          /* extend the life range to the outermost loop */
-          unvisitBlocks(ebbs, count);
-          markWholeLoop (ebp, op->key);
+          ic->defKey = def->key;
+          if (IS_AUTOSYM (def))
+            {
+              lrb->autoDef = bitVectSetBit (lrb->autoDef, def->key);
+              if (IS_ITEMP (def))
+                {
+                  touchLiveOperand (def);
+                  lrb->def = bitVectSetBit (lrb->def, def->key);
+                  lrb->seen = bitVectSetBit (lrb->seen, def->key);
+                }
+            }
         }
-    }
-}
+      else if (!SKIP_IC2 (ic) && ic->op != IFX && ic->op != JUMPTABLE && !POINTER_SET (ic) && IC_RESULT (ic))
+        ic->defKey = IC_RESULT (ic)->key;
 
-/*-----------------------------------------------------------------*/
-/* incUsed - increment a symbol's usage count                      */
-/*-----------------------------------------------------------------*/
-static void
-incUsed (iCode *ic, operand *op)
-{
-  if (ic->depth)
-    OP_SYMBOL (op)->used += (((unsigned int) 1 << ic->depth) + 1);
-  else
-    OP_SYMBOL (op)->used += 1;
+      if (ic == lrb->ebp->ech)
+        break;
+    }
 }
 
 /*-----------------------------------------------------------------*/
-/* rliveClear - clears the rlive bitVectors                        */
+/* lrSolve - solves the backward liveness and the forward "seen"   */
+/*           and "maybe undefined" problems with work lists        */
 /*-----------------------------------------------------------------*/
 static void
-rliveClear (eBBlock **ebbs, int count)
+lrSolve (lrBlock *lrbs, int count, bitVect *allAutos)
 {
+  lrBlock **work = Safe_alloc (count * sizeof (lrBlock *));
+  int nwork = 0;
   int i;
 
-  /* for all blocks do */
+  /* backward: liveIn = use | (liveOut & ~def) */
   for (i = 0; i < count; i++)
     {
-      iCode *ic;
+      lrbs[i].liveIn = bitVectCopy (lrbs[i].use);
+      lrbs[i].liveOut = lrNewSet ();
+      lrbs[i].onList = 1;
+      work[nwork++] = &lrbs[i];
+    }
 
-      /* for all instructions in this block do */
-      for (ic = ebbs[i]->sch; ic; ic = ic->next)
+  /* popping from the end visits the blocks in reverse order first */
+  while (nwork)
+    {
+      lrBlock *lrb = work[--nwork];
+      lrBlock *pred;
+      bitVect *in, *out;
+      eBBlock *ebp;
+
+      lrb->onList = 0;
+
+      for (ebp = setFirstItem (lrb->ebp->succList); ebp; ebp = setNextItem (lrb->ebp->succList))
         {
-	      freeBitVect (ic->rlive);
-	      ic->rlive = NULL;
-	    }
+          lrBlock *succ = lrBlockOf (lrbs, ebp);
+
+          if (!succ)
+            continue;
+          out = bitVectUnion (lrb->liveOut, succ->liveIn);
+          freeBitVect (lrb->liveOut);
+          lrb->liveOut = out;
+        }
+
+      out = bitVectCplAnd (bitVectCopy (lrb->liveOut), lrb->def);
+      in = bitVectUnion (out, lrb->use);
+      freeBitVect (out);
+      if (bitVectEqual (in, lrb->liveIn))
+        {
+          freeBitVect (in);
+          continue;
+        }
+      freeBitVect (lrb->liveIn);
+      lrb->liveIn = in;
+
+      /* predList leaves out the back edges of loops */
+      for (pred = setFirstItem (lrb->preds); pred; pred = setNextItem (lrb->preds))
+        if (!pred->onList)
+          {
+            pred->onList = 1;
+            work[nwork++] = pred;
+          }
+    }
+
+  /* forward: seenIn = | (seenIn | seen) of the predecessors,
+     undefIn = | (undefIn & ~autoDef) of the predecessors,
+     undefIn = all autosyms for blocks without predecessors */
+  for (i = count - 1; i >= 0; i--)
+    {
+      lrbs[i].seenIn = lrNewSet ();
+      lrbs[i].undefIn = setFirstItem (lrbs[i].ebp->predList) ? lrNewSet () : bitVectCopy (allAutos);
+      lrbs[i].onList = 1;
+      work[nwork++] = &lrbs[i];
+    }
+
+  while (nwork)
+    {
+      lrBlock *lrb = work[--nwork];
+      bitVect *seenOut, *undefOut;
+      eBBlock *ebp;
+
+      lrb->onList = 0;
+
+      seenOut = bitVectUnion (lrb->seenIn, lrb->seen);
+      undefOut = bitVectCplAnd (bitVectCopy (lrb->undefIn), lrb->autoDef);
+
+      for (ebp = setFirstItem (lrb->ebp->succList); ebp; ebp = setNextItem (lrb->ebp->succList))
+        {
+          lrBlock *succ = lrBlockOf (lrbs, ebp);
+          bitVect *seenIn, *undefIn;
+          bool changed;
+
+          if (!succ)
+            continue;
+
+          seenIn = bitVectUnion (succ->seenIn, seenOut);
+          undefIn = bitVectUnion (succ->undefIn, undefOut);
+          changed = !bitVectEqual (seenIn, succ->seenIn) || !bitVectEqual (undefIn, succ->undefIn);
+          freeBitVect (succ->seenIn);
+          freeBitVect (succ->undefIn);
+          succ->seenIn = seenIn;
+          succ->undefIn = undefIn;
+
+          if (changed && !succ->onList)
+            {
+              succ->onList = 1;
+              work[nwork++] = succ;
+            }
+        }
+
+      freeBitVect (seenOut);
+      freeBitVect (undefOut);
     }
+
+  Safe_free (work);
 }
 
 /*-----------------------------------------------------------------*/
-/* rlivePoint - for each point compute the ranges that are alive   */
-/* The live range is only stored for ITEMPs; the same code is used */
-/* to find use of unitialized AUTOSYMs (an ITEMP is an AUTOSYM).   */
+/* lrExpand - expands the block liveness to the iCodes of a block  */
 /*-----------------------------------------------------------------*/
 static void
-rlivePoint (eBBlock ** ebbs, int count, bool emitWarnings)
+lrExpand (lrBlock *lrb)
 {
-  int i, key;
-  eBBlock *succ;
-  bitVect *alive;
+  bitVect *live = bitVectCopy (lrb->liveOut);
+  bitVect *unseen;
+  operand *uses[3], *def;
+  iCode *ic;
+  int n, j, key;
 
-  /* for all blocks do */
-  for (i = 0; i < count; i++)
+  /* backward: an iTemp is alive at an iCode if it is used there,
+     defined there or alive after it */
+  for (ic = lrb->ebp->ech; ic; ic = ic->prev)
     {
-      iCode *ic;
+      freeBitVect (ic->rlive);
+      ic->rlive = bitVectCopy (live);
 
-      /* for all instructions in this block do */
-      for (ic = ebbs[i]->sch; ic; ic = ic->next)
+      n = icLiveOperands (ic, uses, &def);
+      if (def && IS_ITEMP (def))
         {
+          ic->rlive = bitVectSetBit (ic->rlive, def->key);
+          bitVectUnSetBit (live, def->key);
+        }
+      for (j = 0; j < n; j++)
+        if (IS_ITEMP (uses[j]))
+          {
+            ic->rlive = bitVectSetBit (ic->rlive, uses[j]->key);
+            live = bitVectSetBit (live, uses[j]->key);
+          }
 
-	  if (!ic->rlive)
-	    ic->rlive = newBitVect (operandKey);
-
-	  if (SKIP_IC2(ic))
-	    continue;
+      if (ic == lrb->ebp->sch)
+        break;
+    }
+  freeBitVect (live);
 
-	  if (ic->op == JUMPTABLE && IS_SYMOP(IC_JTCOND(ic)))
-	    {
-	      incUsed (ic, IC_JTCOND(ic));
+  /* forward: a live range starts at the first use or definition,
+     drop iTemps that are alive before they are seen at all */
+  unseen = bitVectCplAnd (bitVectCopy (lrb->liveIn), lrb->seenIn);
+  if (bitVectIsZero (unseen))
+    {
+      freeBitVect (unseen);
+      return;
+    }
 
-	      if (!IS_AUTOSYM(IC_JTCOND(ic)))
-	        continue;
+  for (ic = lrb->ebp->sch; ic; ic = ic->next)
+    {
+      n = icLiveOperands (ic, uses, &def);
+      if (def)
+        bitVectUnSetBit (unseen, def->key);
+      for (j = 0; j < n; j++)
+        bitVectUnSetBit (unseen, uses[j]->key);
+
+      for (key = 1; key < unseen->size; key++)
+        if (bitVectBitValue (unseen, key))
+          bitVectUnSetBit (ic->rlive, key);
+
+      if (ic == lrb->ebp->ech)
+        break;
+    }
+  freeBitVect (unseen);
+}
 
-	      findPrevUse (ebbs[i], ic, IC_JTCOND(ic), ebbs, count, emitWarnings);
-              if (IS_ITEMP(IC_JTCOND(ic)))
-                {
-                  unvisitBlocks(ebbs, count);
-                  ic->rlive = bitVectSetBit (ic->rlive, IC_JTCOND(ic)->key);
-                  findNextUse (ebbs[i], ic->next, IC_JTCOND(ic));
-                }
+/*-----------------------------------------------------------------*/
+/* lrCheckDefined - warns about autosyms used before definition    */
+/*                  and extends such iTemps over their loop        */
+/*-----------------------------------------------------------------*/
+static void
+lrCheckDefined (lrBlock *lrb, eBBlock ** ebbs, int count, bool emitWarnings)
+{
+  bitVect *undef;
+  operand *uses[3], *def;
+  iCode *ic;
+  int n, j;
 
-	      continue;
-	    }
+  if (bitVectIsZero (lrb->undefIn))
+    return;
 
-	  if (ic->op == IFX && IS_SYMOP(IC_COND(ic)))
-	    {
-	      incUsed (ic, IC_COND(ic));
+  undef = bitVectCopy (lrb->undefIn);
+  for (ic = lrb->ebp->sch; ic; ic = ic->next)
+    {
+      n = icLiveOperands (ic, uses, &def);
+      for (j = 0; j < n; j++)
+        {
+          operand *op = uses[j];
 
-	      if (!IS_AUTOSYM(IC_COND(ic)))
-	        continue;
+          if (!IS_AUTOSYM (op) || (ic->op == ADDRESS_OF && op == IC_LEFT (ic)))
+            continue;
+          if (!bitVectBitValue (undef, op->key))
+            continue;
 
-	      findPrevUse (ebbs[i], ic, IC_COND(ic), ebbs, count, emitWarnings);
-              if (IS_ITEMP(IC_COND(ic)))
+          /* computeLiveRanges() is called at least twice */
+          if (emitWarnings)
+            {
+              if (IS_ITEMP (op))
+                {
+                  if (OP_SYMBOL (op)->prereqv)
+                    {
+                      werrorfl (ic->filename, ic->lineno, W_LOCAL_NOINIT,
+                                OP_SYMBOL (op)->prereqv->name);
+                      OP_SYMBOL (op)->prereqv->reqv = NULL;
+                      OP_SYMBOL (op)->prereqv->allocreq = 1;
+                    }
+                }
+              else
                 {
-                  unvisitBlocks (ebbs, count);
-                  ic->rlive = bitVectSetBit (ic->rlive, IC_COND(ic)->key);
-                  findNextUse (ebbs[i], ic->next, IC_COND(ic));
+                  werrorfl (ic->filename, ic->lineno, W_LOCAL_NOINIT,
+                            OP_SYMBOL (op)->name);
                 }
+            }
+          /* is this block part of a loop? */
+          if (IS_ITEMP (op) && lrb->ebp->depth != 0)
+            {
+              /* extend the life range to the outermost loop */
+              unvisitBlocks (ebbs, count);
+              markWholeLoop (lrb->ebp, op->key);
+            }
+        }
 
-	      continue;
-	    }
+      if (ic->op == ADDRESS_OF && IS_AUTOSYM (IC_LEFT (ic)))
+        bitVectUnSetBit (undef, IC_LEFT (ic)->key);
+      if (def && IS_AUTOSYM (def))
+        bitVectUnSetBit (undef, def->key);
 
-	  if (IS_SYMOP(IC_LEFT(ic)))
-	    {
-	      incUsed (ic, IC_LEFT(ic));
-	      if (IS_AUTOSYM(IC_LEFT(ic)) &&
-	          ic->op != ADDRESS_OF)
-	        {
-	          findPrevUse (ebbs[i], ic, IC_LEFT(ic), ebbs, count, emitWarnings);
-                  if (IS_ITEMP(IC_LEFT(ic)))
-                    {
-                      unvisitBlocks(ebbs, count);
-                      ic->rlive = bitVectSetBit (ic->rlive, IC_LEFT(ic)->key);
-                      findNextUse (ebbs[i], ic->next, IC_LEFT(ic));
-
-                      /* if this is a send extend the LR to the call */
-                      if (ic->op == SEND)
-                        {
-                          iCode *lic;
-                          for (lic = ic; lic; lic = lic->next)
-                            {
-                              if (lic->op == CALL || lic->op == PCALL)
-                                {
-                                  markAlive (ic, lic->prev, IC_LEFT (ic)->key);
-                                  break;
-                                }
-                            }
-                        }
-                    }
-		}
-	    }
+      if (ic == lrb->ebp->ech)
+        break;
+    }
+  freeBitVect (undef);
+}
 
-	  if (IS_SYMOP(IC_RIGHT(ic)))
-	    {
-	      incUsed (ic, IC_RIGHT(ic));
-              if (IS_AUTOSYM(IC_RIGHT(ic)))
-	        {
-	          findPrevUse (ebbs[i], ic, IC_RIGHT(ic), ebbs, count, emitWarnings);
-                  if (IS_ITEMP(IC_RIGHT(ic)))
-                    {
-                      unvisitBlocks(ebbs, count);
-                      ic->rlive = bitVectSetBit (ic->rlive, IC_RIGHT(ic)->key);
-                      findNextUse (ebbs[i], ic->next, IC_RIGHT(ic));
-                    }
-		}
-	    }
+/*-----------------------------------------------------------------*/
+/* rlivePoint - for each point compute the ranges that are alive   */
+/* The live range is only stored for ITEMPs; the same code is used */
+/* to find use of unitialized AUTOSYMs (an ITEMP is an AUTOSYM).   */
+/* Liveness is solved once per block with work lists and then      */
+/* expanded to the iCodes in a single backward pass per block.     */
+/*-----------------------------------------------------------------*/
+static void
+rlivePoint (eBBlock ** ebbs, int count, bool emitWarnings)
+{
+  lrBlock *lrbs;
+  bitVect *allAutos = NULL;
+  int i;
 
-	  if (POINTER_SET(ic) && IS_SYMOP(IC_RESULT(ic)))
-	    incUsed (ic, IC_RESULT(ic));
+  if (!count)
+    return;
 
-          if (IS_AUTOSYM(IC_RESULT(ic)))
-	    {
-	      if (POINTER_SET(ic))
-	        {
-	          findPrevUse (ebbs[i], ic, IC_RESULT(ic), ebbs, count, emitWarnings);
-		}
-              if (IS_ITEMP(IC_RESULT(ic)))
-                {
-                  unvisitBlocks(ebbs, count);
-                  ic->rlive = bitVectSetBit (ic->rlive, IC_RESULT(ic)->key);
-                  findNextUse (ebbs[i], ic->next, IC_RESULT(ic));
-                  /* findNextUse sometimes returns 0 here, which means that ic is
-                     dead code. Something should be done about this dead code since
-                     e.g. register allocation suffers. */
-                }
-	    }
+  lrbs = Safe_alloc (count * sizeof (lrBlock));
 
-	  if (!POINTER_SET(ic) && IC_RESULT(ic))
-	    ic->defKey = IC_RESULT(ic)->key;
+  lrIndexSize = 0;
+  for (i = 0; i < count; i++)
+    if (ebbs[i]->bbnum >= lrIndexSize)
+      lrIndexSize = ebbs[i]->bbnum + 1;
+  lrIndex = Safe_alloc (lrIndexSize * sizeof (int));
+  memset (lrIndex, -1, lrIndexSize * sizeof (int));
 
-	}
+  /* the local use and def sets of the blocks */
+  for (i = 0; i < count; i++)
+    {
+      iCode *ic;
 
-      /* check all symbols that are alive in the last instruction */
-      /* but are not alive in all successors */
+      for (ic = ebbs[i]->sch; ic; ic = ic->next)
+        {
+          if (!ic->rlive)
+            ic->rlive = lrNewSet ();
+          if (ic == ebbs[i]->ech)
+            break;
+        }
 
-      succ = setFirstItem (ebbs[i]->succList);
-      if (!succ)
-        continue;
+      lrbs[i].ebp = ebbs[i];
+      if (ebbs[i]->bbnum >= 0)
+        lrIndex[ebbs[i]->bbnum] = i;
+      if (ebbs[i]->sch)
+        lrLocalSets (&lrbs[i], &allAutos);
+      else
+        {
+          lrbs[i].use = lrNewSet ();
+          lrbs[i].def = lrNewSet ();
+          lrbs[i].seen = lrNewSet ();
+          lrbs[i].autoDef = lrNewSet ();
+        }
+    }
+  if (!allAutos)
+    allAutos = lrNewSet ();
 
-      alive = succ->sch->rlive;
-      while ((succ = setNextItem (ebbs[i]->succList)))
+  for (i = 0; i < count; i++)
+    {
+      eBBlock *ebp;
+
+      for (ebp = setFirstItem (ebbs[i]->succList); ebp; ebp = setNextItem (ebbs[i]->succList))
         {
-	  if (succ->sch)
-            alive = bitVectIntersect (alive, succ->sch->rlive);
-	}
+          lrBlock *succ = lrBlockOf (lrbs, ebp);
+
+          if (succ)
+            addSetIfnotP (&succ->preds, &lrbs[i]);
+        }
+    }
+
+  lrSolve (lrbs, count, allAutos);
 
-      if (ebbs[i]->ech)
-        alive = bitVectCplAnd ( bitVectCopy (ebbs[i]->ech->rlive), alive);
+  for (i = 0; i < count; i++)
+    if (ebbs[i]->sch)
+      lrExpand (&lrbs[i]);
 
-      if(!alive)
+  for (i = 0; i < count; i++)
+    {
+      iCode *ic;
+
+      if (!ebbs[i]->sch)
         continue;
-      for (key = 1; key < alive->size; key++)
+
+      /* if this is a send extend the LR to the call */
+      for (ic = ebbs[i]->sch; ic; ic = ic->next)
         {
-	  if (!bitVectBitValue (alive, key))
-	    continue;
+          if (ic->op == SEND && IS_ITEMP (IC_LEFT (ic)))
+            {
+              iCode *lic;
+              for (lic = ic; lic; lic = lic->next)
+                {
+                  if (lic->op == CALL || lic->op == PCALL)
+                    {
+                      markAlive (ic, lic->prev, IC_LEFT (ic)->key);
+                      break;
+                    }
+                }
+            }
+          if (ic == ebbs[i]->ech)
+            break;
+        }
 
-	  unvisitBlocks(ebbs, count);
-	  findNextUseSym (ebbs[i], NULL, hTabItemWithKey (liveRanges, key));
-	}
+      lrCheckDefined (&lrbs[i], ebbs, count, emitWarnings);
+    }
 
+  for (i = 0; i < count; i++)
+    {
+      freeBitVect (lrbs[i].use);
+      freeBitVect (lrbs[i].def);
+      freeBitVect (lrbs[i].seen);
+      freeBitVect (lrbs[i].autoDef);
+      freeBitVect (lrbs[i].liveIn);
+      freeBitVect (lrbs[i].liveOut);
+      freeBitVect (lrbs[i].seenIn);
+      freeBitVect (lrbs[i].undefIn);
+      deleteSet (&lrbs[i].preds);
     }
+  freeBitVect (allAutos);
+  Safe_free (lrbs);
+  Safe_free (lrIndex);
+  lrIndex = NULL;
 }
 
 /*-----------------------------------------------------------------*/
@@ -848,6 +980,8 @@ adjustIChain (eBBlock ** ebbs, int count)
 void
 computeLiveRanges (eBBlock **ebbs, int count, bool emitWarnings)
 {
+  timerBegin ("computeLiveRanges");
+
   /* first look through all blocks and adjust the
      sch and ech pointers */
   adjustIChain (ebbs, count);
@@ -872,6 +1006,8 @@ computeLiveRanges (eBBlock **ebbs, int count, bool emitWarnings)
 
   /* compute which overlaps with what */
   computeClash(ebbs, count);
+
+  timerEnd ("computeLiveRanges");
 }
 
 /*-----------------------------------------------------------------*/
@@ -1069,6 +1205,9 @@ separateLiveRanges (iCode *sic, ebbIndex *ebbi)
             {
               operand *tmpop = newiTempOperand (operandType (IC_RESULT ((iCode *)(setFirstItem (newdefs)))), TRUE);
 
+              OP_SYMBOL (tmpop)->key = tmpop->key;
+              hTabAddItemIfNotP (&liveRanges, tmpop->key, OP_SYMBOL (tmpop));
+
               // printf("Splitting %s from %s, using def at %d, op %d\n", OP_SYMBOL_CONST(tmpop)->name, sym->name, ((iCode *)(setFirstItem (newdefs)))->key, ((iCode *)(setFirstItem (newdefs)))->op);
 
               for (ic = setFirstItem (visited); ic; ic = setNextItem (visited))
@@ -1079,6 +1218,12 @@ separateLiveRanges (iCode *sic, ebbIndex *ebbi)
                       IC_RIGHT (ic) = operandFromOperand (tmpop);
                   if (IC_RESULT (ic) && IS_ITEMP (IC_RESULT (ic)) && OP_SYMBOL (IC_RESULT (ic)) == sym && !POINTER_SET(ic) && ic->next && !isinSet (visited, ic->next))
                     continue;
+                  /* keep the live ranges up to date: the new temporary takes over the visited part */
+                  if (bitVectBitValue (ic->rlive, sym->key))
+                    {
+                      bitVectUnSetBit (ic->rlive, sym->key);
+                      ic->rlive = bitVectSetBit (ic->rlive, tmpop->key);
+                    }
                   if (IC_RESULT (ic) && IS_ITEMP (IC_RESULT (ic)) && OP_SYMBOL (IC_RESULT (ic)) == sym)
                     {
                       bool pset = POINTER_SET(ic);
@@ -0,0 +1,1013 @@
+/*-------------------------------------------------------------------------
+  SDCClto.c - link-time optimization (--lto)
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+/* With --lto, "sdcc -c" writes an object that holds the preprocessed
+   source instead of assembled code, followed by a summary of every
+   function: its attributes, its size in iCodes and the functions it
+   calls or references. When such objects are linked, the summaries of
+   the whole program are read and decisions are taken that no single
+   module could take:
+
+   - functions nobody outside the objects references become static,
+   - static functions that can't be reached from a root are dropped,
+   - functions called from one place, or small ones, are inlined,
+   - on the z80 family, functions with one parameter of up to four
+     bytes get it in registers (__z88dk_fastcall).
+
+   The objects are then compiled as one module, a source with the
+   decisions as "#pragma sdcc_lto" in front followed by the objects,
+   each starting with "#pragma sdcc_lto module <n>". Every module starts
+   with the options of the command line, and symbols private to a module
+   (statics, typedefs, tags, enumerators) are removed from the symbol
+   table when it ends. Statics keep their names in C, but are emitted as
+   __lto<n>_<name>.
+
+   The roots are main, interrupt service routines, banked functions, the
+   functions referenced by the other object files of the link, by inline
+   assembler or from initializers, names beginning with an underscore
+   and the functions declared in system headers, that the libraries may
+   call back. */
+
+#include "common.h"
+#include "dbuf_string.h"
+
+#define LTO_HASH_SIZE   1021
+
+/* Inlined into all callers below this many iCodes */
+#define LTO_INLINE_SIZE         6
+#define LTO_INLINE_SIZE_SMALL   3
+
+/* Decisions, from the "#pragma sdcc_lto" of the combined source */
+#define PLAN_STATIC     0x01
+#define PLAN_DROP       0x02
+#define PLAN_INLINE     0x04
+#define PLAN_FASTCALL   0x08
+
+/* What a function uses, while summarizing it */
+#define LTO_USES_MODULE         0x01
+#define LTO_USES_STATIC_LOCAL   0x02
+
+/* A function or decision, by name and module. Module 0 is global. */
+struct ltoKey
+{
+  const char *name;             /* interned */
+  int module;
+};
+
+struct ltoPlan
+{
+  struct ltoKey key;
+  int what;                     /* PLAN_... */
+};
+
+/* An object, while linking */
+struct ltoObject
+{
+  const char *file;
+  int module;                   /* from 1 */
+  struct dbuf_s text;
+  set *modules;                 /* the objects it calls */
+  int nfuncs;
+  int order;                    /* position in the combined source, 0 while unplaced */
+  bool visiting;
+};
+
+/* A function of an object, while linking */
+struct ltoFunc
+{
+  struct ltoKey key;
+  struct ltoObject *obj;
+  int seq;                      /* position in its object */
+  char flags[16];
+  int size;
+  int nparams;
+  int psize;                    /* size of the only parameter, if it can go to registers */
+  set *callNames;               /* names called, one for each call */
+  set *refNames;                /* names referenced */
+  set *edges;                   /* functions called or referenced */
+  set *callers;                 /* calling function, one for each call */
+  bool root;
+  bool addrTaken;
+  bool blockDecl;               /* declared at block scope or implicitly somewhere */
+  bool reached;
+  int plan;
+};
+
+/* A name summarized outside of a function */
+struct ltoName
+{
+  struct ltoObject *obj;
+  char kind;
+  const char *name;
+};
+
+/* Compiling an object */
+static bool objectMode;
+static struct dbuf_s objSource;
+static struct dbuf_s objSummary;
+static set *sysDecls;           /* names of functions declared in system headers */
+static set *defined;            /* names of global functions defined */
+
+/* Compiling the combined source */
+static bool combined;
+static int currModule;
+static hTab *plans;
+
+/*-----------------------------------------------------------------*/
+/* keyHash, keyCompare - hash table keys                           */
+/*-----------------------------------------------------------------*/
+static int
+keyHash (const char *name, int module)
+{
+  return (int) ((internHashOf (name) + module) % LTO_HASH_SIZE);
+}
+
+static int
+keyCompare (const void *a, const void *b)
+{
+  const struct ltoKey *ka = a, *kb = b;
+
+  return ka->name == kb->name && ka->module == kb->module;
+}
+
+static void *
+findKey (hTab *tab, const char *name, int module)
+{
+  struct ltoKey key;
+
+  key.name = name;
+  key.module = module;
+  return hTabFindByKey (tab, keyHash (name, module), &key, keyCompare);
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoBeginObject - reads the preprocessed source of an object     */
+/*-----------------------------------------------------------------*/
+bool
+ltoBeginObject (void)
+{
+  char buf[4096];
+  size_t len;
+
+  if (!options.lto || options.c1mode || !fullSrcFileName || noAssemble)
+    return FALSE;
+
+  /* the parser reads the preprocessed source from a copy */
+  dbuf_init (&objSource, 64 * 1024);
+  while ((len = fread (buf, 1, sizeof (buf), yyin)) != 0)
+    dbuf_append (&objSource, buf, len);
+  if (sdcc_pclose (yyin))
+    exit (EXIT_FAILURE);
+  if (!(yyin = tmpfile ()) || fwrite (dbuf_get_buf (&objSource), 1, dbuf_get_length (&objSource), yyin) != dbuf_get_length (&objSource))
+    {
+      werror (E_TMPFILE_FAILED);
+      exit (EXIT_FAILURE);
+    }
+  rewind (yyin);
+
+  dbuf_init (&objSummary, 4096);
+  objectMode = TRUE;
+  return TRUE;
+}
+
+bool
+ltoObjectMode (void)
+{
+  return objectMode;
+}
+
+/*-----------------------------------------------------------------*/
+/* summarizeOperand - records a function an operand refers to      */
+/*-----------------------------------------------------------------*/
+static void
+summarizeOperand (operand *op, struct dbuf_s *refs, bool call, int *flags)
+{
+  symbol *sym;
+
+  if (!IS_SYMOP (op) || OP_SYMBOL (op)->isitmp)
+    return;
+  sym = OP_SYMBOL (op);
+
+  /* module private symbols keep the function in its module */
+  if (!sym->level && IS_STATIC (sym->etype) && sym != currFunc)
+    *flags |= LTO_USES_MODULE;
+  if (sym->level && IS_STATIC (sym->etype) && !IS_FUNC (sym->type))
+    *flags |= LTO_USES_STATIC_LOCAL;
+
+  if (!IS_FUNC (sym->type))
+    return;
+  dbuf_printf (refs, "#lto %c %s\n", call ? 'C' : 'R', sym->name);
+  if (sym->level)
+    dbuf_printf (&objSummary, "#lto L %s\n", sym->name);
+}
+
+/*-----------------------------------------------------------------*/
+/* summarizeAsm - the functions inline assembler may refer to      */
+/*-----------------------------------------------------------------*/
+static void
+summarizeAsm (const char *s)
+{
+  size_t prefix = strlen (port->fun_prefix);
+
+  while (*s)
+    {
+      if (isalpha ((unsigned char) *s) || *s == '_')
+        {
+          const char *b = s;
+
+          while (isalnum ((unsigned char) *s) || *s == '_')
+            s++;
+          if (s - b > prefix && !strncmp (b, port->fun_prefix, prefix))
+            dbuf_printf (&objSummary, "#lto X %.*s\n", (int) (s - b - prefix), b + prefix);
+        }
+      else
+        s++;
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoFunction - summarizes the function being compiled            */
+/*-----------------------------------------------------------------*/
+void
+ltoFunction (ebbIndex *ebbi)
+{
+  symbol *func = currFunc;
+  sym_link *ftype;
+  struct dbuf_s refs;
+  char flags[16];
+  char *f = flags;
+  int uses = 0;
+  int size = 0;
+  int nparams = 0;
+  int psize = 0;
+  bool hasAsm = FALSE;
+  bool aggregate = FALSE;
+  value *arg;
+  int i;
+
+  if (!func)
+    return;
+  ftype = func->type;
+
+  dbuf_init (&refs, 1024);
+  for (i = 0; i < ebbi->count; i++)
+    {
+      iCode *ic;
+
+      for (ic = ebbi->bbOrder[i]->sch; ic; ic = ic->next)
+        {
+          if (ic->op == LABEL || ic->op == FUNCTION || ic->op == ENDFUNCTION)
+            continue;
+          size++;
+
+          if (ic->op == INLINEASM)
+            {
+              hasAsm = TRUE;
+              summarizeAsm (IC_INLINE (ic));
+              continue;
+            }
+          if (ic->op == IFX || ic->op == JUMPTABLE)
+            {
+              summarizeOperand (IC_COND (ic), &refs, FALSE, &uses);
+              continue;
+            }
+          summarizeOperand (IC_LEFT (ic), &refs, ic->op == CALL, &uses);
+          summarizeOperand (IC_RIGHT (ic), &refs, FALSE, &uses);
+          summarizeOperand (IC_RESULT (ic), &refs, FALSE, &uses);
+        }
+    }
+
+  for (arg = FUNC_ARGS (ftype); arg; arg = arg->next)
+    if (!IS_VOID (arg->type))
+      {
+        nparams++;
+        if (IS_AGGREGATE (arg->type) || IS_BITVAR (arg->etype))
+          aggregate = TRUE;
+        else if ((IS_INTEGRAL (arg->type) || IS_PTR (arg->type)))
+          psize = getSize (arg->type);
+      }
+  if (nparams != 1)
+    psize = 0;
+
+  if (IS_STATIC (func->etype))
+    *f++ = 's';
+  else
+    addSet (&defined, (void *) func->name);
+  if (IFFUNC_ISISR (ftype))
+    *f++ = 'i';
+  if (IFFUNC_HASVARARGS (ftype))
+    *f++ = 'v';
+  if (IFFUNC_ISNAKED (ftype))
+    *f++ = 'n';
+  if (IFFUNC_ISBANKEDCALL (ftype))
+    *f++ = 'b';
+  if (IFFUNC_ISCRITICAL (ftype) || IFFUNC_ISSMALLC (ftype) || IFFUNC_ISZ88DK_FASTCALL (ftype) || IFFUNC_ISZ88DK_CALLEE (ftype) ||
+      IFFUNC_ISINLINE (ftype) || IFFUNC_ISSHADOWREGS (ftype) || IFFUNC_ISOVERLAY (ftype) || IFFUNC_ISNORETURN (ftype) ||
+      IFFUNC_ISBUILTIN (ftype) || IFFUNC_ISWPARAM (ftype) || IFFUNC_ISJAVANATIVE (ftype) || FUNC_REGBANK (ftype) ||
+      SPEC_ABSA (func->etype))
+    *f++ = 'k';
+  if (aggregate || IS_AGGREGATE (ftype->next) || IS_BITVAR (getSpec (ftype->next)))
+    *f++ = 'p';
+  if (hasAsm)
+    *f++ = 'a';
+  if (uses & LTO_USES_STATIC_LOCAL)
+    *f++ = 'l';
+  if (uses & LTO_USES_MODULE)
+    *f++ = 'm';
+  if (f == flags)
+    *f++ = '-';
+  *f = '\0';
+
+  dbuf_printf (&objSummary, "#lto F %s %s %d %d %d\n", func->name, flags, size, nparams, psize);
+  dbuf_append (&objSummary, dbuf_get_buf (&refs), dbuf_get_length (&refs));
+  dbuf_destroy (&refs);
+}
+
+/*-----------------------------------------------------------------*/
+/* summarizeTree - the names an initializer refers to              */
+/*-----------------------------------------------------------------*/
+static void
+summarizeTree (ast *tree)
+{
+  if (!tree)
+    return;
+  if (IS_AST_VALUE (tree) && tree->opval.val->sym && !tree->opval.val->sym->islbl)
+    dbuf_printf (&objSummary, "#lto A %s\n", tree->opval.val->sym->name);
+  if (tree->type == EX_OP)
+    {
+      summarizeTree (tree->left);
+      summarizeTree (tree->right);
+    }
+}
+
+static void
+summarizeInit (initList *ilist)
+{
+  for (; ilist; ilist = ilist->next)
+    if (ilist->type == INIT_NODE)
+      summarizeTree (ilist->init.node);
+    else
+      summarizeInit (ilist->init.deep);
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoWriteObject - writes the object instead of assembled code    */
+/*-----------------------------------------------------------------*/
+void
+ltoWriteObject (void)
+{
+  struct dbuf_s name;
+  const char *s;
+  FILE *f;
+
+  dbuf_init (&name, PATH_MAX);
+  if (options.cc_only && fullDstFileName)
+    dbuf_append_str (&name, fullDstFileName);
+  else
+    dbuf_printf (&name, "%s%s", dstFileName, port->linker.rel_ext);
+
+  /* the functions the libraries may call back */
+  for (s = setFirstItem (defined); s; s = setNextItem (defined))
+    if (isinSet (sysDecls, s))
+      dbuf_printf (&objSummary, "#lto X %s\n", s);
+
+  if (!(f = fopen (dbuf_c_str (&name), "w")))
+    {
+      werror (E_FILE_OPEN_ERR, dbuf_c_str (&name));
+      exit (EXIT_FAILURE);
+    }
+  fprintf (f, "#sdcc lto %s\n", port->target);
+  fwrite (dbuf_get_buf (&objSource), 1, dbuf_get_length (&objSource), f);
+  if (dbuf_get_length (&objSource) && ((const char *) dbuf_get_buf (&objSource))[dbuf_get_length (&objSource) - 1] != '\n')
+    fputc ('\n', f);
+  fwrite (dbuf_get_buf (&objSummary), 1, dbuf_get_length (&objSummary), f);
+  if (fclose (f))
+    {
+      werror (E_FILE_OPEN_ERR, dbuf_c_str (&name));
+      exit (EXIT_FAILURE);
+    }
+  dbuf_destroy (&name);
+}
+
+/*-----------------------------------------------------------------*/
+/* readFile - reads a whole file, returns FALSE if it can't        */
+/*-----------------------------------------------------------------*/
+static bool
+readFile (const char *name, struct dbuf_s *text)
+{
+  char buf[4096];
+  size_t len;
+  FILE *f;
+
+  if (!(f = fopen (name, "r")))
+    return FALSE;
+  while ((len = fread (buf, 1, sizeof (buf), f)) != 0)
+    dbuf_append (text, buf, len);
+  fclose (f);
+  return TRUE;
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoIsObject - checks for the first line of an object            */
+/*-----------------------------------------------------------------*/
+bool
+ltoIsObject (const char *name)
+{
+  char buf[16];
+  FILE *f;
+  bool ret;
+
+  if (!(f = fopen (name, "r")))
+    return FALSE;
+  ret = fgets (buf, sizeof (buf), f) && !strncmp (buf, "#sdcc lto ", 10);
+  fclose (f);
+  return ret;
+}
+
+/*-----------------------------------------------------------------*/
+/* nextLine - returns the next line of a text, NULL at its end     */
+/*-----------------------------------------------------------------*/
+static const char *
+nextLine (const char **p, const char *end, struct dbuf_s *line)
+{
+  const char *s = *p;
+  const char *e;
+
+  if (s >= end)
+    return NULL;
+  for (e = s; e < end && *e != '\n'; e++)
+    ;
+  dbuf_set_length (line, 0);
+  dbuf_append (line, s, e - s);
+  *p = e < end ? e + 1 : e;
+  return dbuf_c_str (line);
+}
+
+/*-----------------------------------------------------------------*/
+/* readObject - reads the summary of an object                     */
+/*-----------------------------------------------------------------*/
+static bool
+readObject (struct ltoObject *obj, hTab **funcs, set **allFuncs, set **names)
+{
+  struct dbuf_s line;
+  struct ltoFunc *func = NULL;
+  const char *p, *end, *s;
+  char kind;
+  char name[256];
+  char flags[16];
+
+  dbuf_init (&obj->text, 64 * 1024);
+  if (!readFile (obj->file, &obj->text))
+    {
+      werror (E_FILE_OPEN_ERR, obj->file);
+      return FALSE;
+    }
+  p = dbuf_get_buf (&obj->text);
+  end = p + dbuf_get_length (&obj->text);
+
+  dbuf_init (&line, 256);
+  s = nextLine (&p, end, &line);
+  if (!s || strncmp (s, "#sdcc lto ", 10) || strcmp (s + 10, port->target))
+    {
+      werror (E_LTO_PORT, obj->file, s && !strncmp (s, "#sdcc lto ", 10) ? s + 10 : "?");
+      dbuf_destroy (&line);
+      return FALSE;
+    }
+
+  while ((s = nextLine (&p, end, &line)))
+    {
+      if (strncmp (s, "#lto ", 5) || sscanf (s + 5, "%c %255s", &kind, name) != 2)
+        continue;
+
+      switch (kind)
+        {
+        case 'F':
+          func = Safe_alloc (sizeof (struct ltoFunc));
+          if (sscanf (s + 5, "F %*s %15s %d %d %d", flags, &func->size, &func->nparams, &func->psize) != 4)
+            {
+              Safe_free (func);
+              func = NULL;
+              break;
+            }
+          strcpy (func->flags, flags);
+          func->obj = obj;
+          func->seq = ++obj->nfuncs;
+          func->key.name = internStr (name);
+          func->key.module = strchr (flags, 's') ? obj->module : 0;
+          /* a second definition is an error the linker reports */
+          if (!findKey (*funcs, func->key.name, func->key.module))
+            hTabAddItemLong (funcs, keyHash (func->key.name, func->key.module), &func->key, func);
+          addSet (allFuncs, func);
+          break;
+
+        case 'C':
+          if (func)
+            addSet (&func->callNames, internStr (name));
+          break;
+
+        case 'R':
+          if (func)
+            addSet (&func->refNames, internStr (name));
+          break;
+
+        case 'L':
+        case 'A':
+        case 'X':
+          {
+            struct ltoName *n = Safe_alloc (sizeof (struct ltoName));
+
+            n->obj = obj;
+            n->kind = kind;
+            n->name = internStr (name);
+            addSet (names, n);
+          }
+          break;
+        }
+    }
+  dbuf_destroy (&line);
+  return TRUE;
+}
+
+/*-----------------------------------------------------------------*/
+/* readReferences - the symbols another object file references     */
+/*-----------------------------------------------------------------*/
+static void
+readReferences (const char *file, set **refs)
+{
+  struct dbuf_s text, line;
+  const char *p, *end, *s;
+  size_t prefix = strlen (port->fun_prefix);
+  char name[256];
+
+  dbuf_init (&text, 16 * 1024);
+  if (!readFile (file, &text))
+    {
+      dbuf_destroy (&text);
+      return;
+    }
+  p = dbuf_get_buf (&text);
+  end = p + dbuf_get_length (&text);
+
+  /* "S <name> Ref<addr>" */
+  dbuf_init (&line, 256);
+  while ((s = nextLine (&p, end, &line)))
+    if (sscanf (s, "S %255s Ref", name) == 1 && strstr (s, " Ref") && !strncmp (name, port->fun_prefix, prefix))
+      addSet (refs, internStr (name + prefix));
+  dbuf_destroy (&line);
+  dbuf_destroy (&text);
+}
+
+/*-----------------------------------------------------------------*/
+/* resolve - the function a name in an object refers to            */
+/*-----------------------------------------------------------------*/
+static struct ltoFunc *
+resolve (hTab *funcs, struct ltoObject *obj, const char *name)
+{
+  struct ltoFunc *func = findKey (funcs, name, obj->module);
+
+  return func ? func : findKey (funcs, name, 0);
+}
+
+/*-----------------------------------------------------------------*/
+/* reach - marks the functions reachable from a root               */
+/*-----------------------------------------------------------------*/
+static void
+reach (struct ltoFunc *func)
+{
+  struct ltoFunc *callee;
+
+  if (func->reached)
+    return;
+  func->reached = TRUE;
+  for (callee = setFirstItem (func->edges); callee; callee = setNextItem (func->edges))
+    reach (callee);
+}
+
+/*-----------------------------------------------------------------*/
+/* place - orders the objects, the called ones first, so inline    */
+/*         functions are defined before their callers              */
+/*-----------------------------------------------------------------*/
+static void
+place (struct ltoObject *obj, set **order, int *n)
+{
+  struct ltoObject *callee;
+
+  if (obj->order || obj->visiting)
+    return;
+  obj->visiting = TRUE;
+  for (callee = setFirstItem (obj->modules); callee; callee = setNextItem (obj->modules))
+    place (callee, order, n);
+  obj->visiting = FALSE;
+  obj->order = ++*n;
+  addSet (order, obj);
+}
+
+/*-----------------------------------------------------------------*/
+/* before - TRUE if function a comes before b in the combined      */
+/*          source                                                 */
+/*-----------------------------------------------------------------*/
+static bool
+before (const struct ltoFunc *a, const struct ltoFunc *b)
+{
+  if (a->obj != b->obj)
+    return a->obj->order < b->obj->order;
+  return a->seq < b->seq;
+}
+
+/*-----------------------------------------------------------------*/
+/* canInline - TRUE if all the calls can be replaced by the body   */
+/*-----------------------------------------------------------------*/
+static bool
+canInline (const struct ltoFunc *func)
+{
+  const struct ltoFunc *caller;
+
+  if (strpbrk (func->flags, "ivnbkpal") || !func->callers)
+    return FALSE;
+  if (elementsInSet (func->callers) > 1 && func->size > (optimize.codeSize ? LTO_INLINE_SIZE_SMALL : LTO_INLINE_SIZE))
+    return FALSE;
+  for (caller = setFirstItem (func->callers); caller; caller = setNextItem (func->callers))
+    {
+      if (!before (func, caller))
+        return FALSE;
+      /* module private symbols are only visible in the module */
+      if (caller->obj != func->obj && strchr (func->flags, 'm'))
+        return FALSE;
+    }
+  return TRUE;
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoCombine - decides for the whole program and writes the       */
+/*              combined source                                    */
+/*-----------------------------------------------------------------*/
+bool
+ltoCombine (set *objects, set *others, const char *name)
+{
+  hTab *funcs = NULL;
+  set *objs = NULL;
+  set *allFuncs = NULL;
+  set *names = NULL;
+  set *refs = NULL;
+  set *order = NULL;
+  struct ltoObject *obj;
+  struct ltoFunc *func, *callee;
+  struct ltoName *n;
+  const char *s;
+  int nobjs = 0;
+  FILE *f;
+
+  for (s = setFirstItem (objects); s; s = setNextItem (objects))
+    {
+      obj = Safe_alloc (sizeof (struct ltoObject));
+      obj->file = s;
+      obj->module = ++nobjs;
+      if (!readObject (obj, &funcs, &allFuncs, &names))
+        return FALSE;
+      addSet (&objs, obj);
+    }
+  for (s = setFirstItem (others); s; s = setNextItem (others))
+    readReferences (s, &refs);
+
+  /* the call graph */
+  for (func = setFirstItem (allFuncs); func; func = setNextItem (allFuncs))
+    {
+      for (s = setFirstItem (func->callNames); s; s = setNextItem (func->callNames))
+        if ((callee = resolve (funcs, func->obj, s)))
+          {
+            addSet (&callee->callers, func);
+            addSetIfnotP (&func->edges, callee);
+            if (callee->obj != func->obj)
+              addSetIfnotP (&func->obj->modules, callee->obj);
+          }
+      for (s = setFirstItem (func->refNames); s; s = setNextItem (func->refNames))
+        if ((callee = resolve (funcs, func->obj, s)))
+          {
+            callee->addrTaken = TRUE;
+            addSetIfnotP (&func->edges, callee);
+          }
+    }
+
+  /* the roots */
+  for (n = setFirstItem (names); n; n = setNextItem (names))
+    if ((func = resolve (funcs, n->obj, n->name)))
+      {
+        if (n->kind == 'L')
+          func->blockDecl = TRUE;
+        else
+          func->root = TRUE;
+        if (n->kind == 'A')
+          func->addrTaken = TRUE;
+      }
+  for (s = setFirstItem (refs); s; s = setNextItem (refs))
+    if ((func = findKey (funcs, s, 0)))
+      func->root = TRUE;
+  for (func = setFirstItem (allFuncs); func; func = setNextItem (allFuncs))
+    {
+      if (strpbrk (func->flags, "ib"))
+        func->root = TRUE;
+      if (!func->key.module && (!strcmp (func->key.name, "main") || func->key.name[0] == '_'))
+        func->root = TRUE;
+    }
+  for (func = setFirstItem (allFuncs); func; func = setNextItem (allFuncs))
+    if (func->root)
+      reach (func);
+
+  {
+    int n = 0;
+
+    for (obj = setFirstItem (objs); obj; obj = setNextItem (objs))
+      place (obj, &order, &n);
+  }
+
+  /* the decisions */
+  for (func = setFirstItem (allFuncs); func; func = setNextItem (allFuncs))
+    {
+      bool internal = func->key.module || (!func->root && !func->blockDecl);
+
+      if (!func->key.module && internal)
+        func->plan |= PLAN_STATIC;
+      if (!internal)
+        continue;
+      if (!func->reached)
+        {
+          func->plan |= PLAN_DROP;
+          continue;
+        }
+      if (func->root || func->addrTaken || func->blockDecl)
+        continue;
+      if (canInline (func))
+        func->plan |= PLAN_INLINE;
+      else if (TARGET_Z80_LIKE && !strpbrk (func->flags, "ivnbkpa") && func->psize >= 1 && func->psize <= 4)
+        func->plan |= PLAN_FASTCALL;
+    }
+
+  if (!(f = fopen (name, "w")))
+    {
+      werror (E_FILE_OPEN_ERR, name);
+      return FALSE;
+    }
+  for (func = setFirstItem (allFuncs); func; func = setNextItem (allFuncs))
+    {
+      if (func->plan & PLAN_STATIC)
+        fprintf (f, "#pragma sdcc_lto static %d %s\n", func->key.module, func->key.name);
+      if (func->plan & PLAN_DROP)
+        fprintf (f, "#pragma sdcc_lto drop %d %s\n", func->key.module, func->key.name);
+      if (func->plan & PLAN_INLINE)
+        fprintf (f, "#pragma sdcc_lto inline %d %s\n", func->key.module, func->key.name);
+      if (func->plan & PLAN_FASTCALL)
+        fprintf (f, "#pragma sdcc_lto fastcall %d %s\n", func->key.module, func->key.name);
+    }
+  for (obj = setFirstItem (order); obj; obj = setNextItem (order))
+    {
+      fprintf (f, "#pragma sdcc_lto module %d\n", obj->module);
+      fwrite (dbuf_get_buf (&obj->text), 1, dbuf_get_length (&obj->text), f);
+      dbuf_destroy (&obj->text);
+    }
+  if (fclose (f))
+    {
+      werror (E_FILE_OPEN_ERR, name);
+      return FALSE;
+    }
+  return TRUE;
+}
+
+/*-----------------------------------------------------------------*/
+/* isModuleLocal - TRUE if a file scope symbol ends with its module */
+/*-----------------------------------------------------------------*/
+static bool
+isModuleLocal (const symbol *sym)
+{
+  struct ltoPlan *plan;
+
+  if (sym->ltoModule)
+    return TRUE;
+  /* inline definitions are local too, unless inlined everywhere */
+  if (IS_FUNC (sym->type) && FUNC_ISINLINE (sym->type) && !IS_STATIC (sym->etype) && !IS_EXTERN (sym->etype))
+    return !((plan = findKey (plans, sym->name, 0)) && (plan->what & PLAN_INLINE));
+  return FALSE;
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoPragma - handles #pragma sdcc_lto                            */
+/*-----------------------------------------------------------------*/
+bool
+ltoPragma (const char *what, int module, const char *name)
+{
+  struct ltoPlan *plan;
+  int bit;
+
+  if (!strcmp (what, "module"))
+    {
+      int i;
+
+      if (name || module <= 0)
+        return FALSE;
+
+      /* the file scope of the previous module ends */
+      for (i = 0; i < HASHTAB_SIZE; i++)
+        {
+          bucket *bp;
+
+          for (bp = SymbolTab[i]; bp; bp = bp->next)
+            if (!bp->level && isModuleLocal (bp->sym))
+              deleteSym (SymbolTab, bp->sym, bp->name);
+        }
+      cleanUpLevel (StructTab, 0);
+      cleanUpLevel (TypedefTab, 0);
+      cleanUpLevel (enumTab, 0);
+
+      combined = TRUE;
+      currModule = module;
+      return TRUE;
+    }
+
+  if (!name || module < 0)
+    return FALSE;
+  if (!strcmp (what, "static"))
+    bit = PLAN_STATIC;
+  else if (!strcmp (what, "drop"))
+    bit = PLAN_DROP;
+  else if (!strcmp (what, "inline"))
+    bit = PLAN_INLINE;
+  else if (!strcmp (what, "fastcall"))
+    bit = PLAN_FASTCALL;
+  else
+    return FALSE;
+
+  name = internStr (name);
+  if (!(plan = findKey (plans, name, module)))
+    {
+      plan = Safe_alloc (sizeof (struct ltoPlan));
+      plan->key.name = name;
+      plan->key.module = module;
+      hTabAddItemLong (&plans, keyHash (name, module), &plan->key, plan);
+    }
+  plan->what |= bit;
+  return TRUE;
+}
+
+bool
+ltoCombined (void)
+{
+  return combined;
+}
+
+/*-----------------------------------------------------------------*/
+/* planFor - the decisions for a function                          */
+/*-----------------------------------------------------------------*/
+static int
+planFor (const symbol *sym)
+{
+  struct ltoPlan *plan = findKey (plans, sym->name, sym->ltoModule);
+
+  return plan ? plan->what : 0;
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoDeclare - records a declaration                              */
+/*-----------------------------------------------------------------*/
+void
+ltoDeclare (symbol *sym)
+{
+  if (objectMode)
+    {
+      if (!IS_FUNC (sym->type))
+        {
+          if ((!sym->level || IS_STATIC (sym->etype)) && sym->ival)
+            summarizeInit (sym->ival);
+        }
+      else if (sym->level)
+        dbuf_printf (&objSummary, "#lto L %s\n", sym->name);
+      else if (lexSystemHeader)
+        addSetIfnotP (&sysDecls, (void *) sym->name);
+      return;
+    }
+
+  if (!combined || sym->level)
+    return;
+
+  if (IS_SPEC (sym->etype) && (IS_STATIC (sym->etype) || IS_TYPEDEF (sym->etype) || (IS_LITERAL (sym->etype) && SPEC_ENUM (sym->etype))))
+    {
+      symbol *csym = findSym (SymbolTab, NULL, sym->name);
+
+      sym->ltoModule = currModule;
+      /* hide a symbol of the same name from another module */
+      if (csym && !csym->level && csym->ltoModule != currModule)
+        deleteSym (SymbolTab, csym, csym->name);
+    }
+
+  if (IS_FUNC (sym->type))
+    {
+      int what = planFor (sym);
+
+      if (what & PLAN_STATIC)
+        {
+          SPEC_STAT (sym->etype) = 1;
+          SPEC_EXTR (sym->etype) = 0;
+        }
+      if (what & PLAN_INLINE)
+        {
+          FUNC_ISINLINE (sym->type) = 1;
+          SPEC_STAT (sym->etype) = 0;
+          SPEC_EXTR (sym->etype) = 0;
+        }
+      /* the parameter goes to registers now */
+      if ((what & PLAN_FASTCALL) && !FUNC_ISZ88DK_FASTCALL (sym->type))
+        {
+          FUNC_ISZ88DK_FASTCALL (sym->type) = 1;
+          FUNC_HASSTACKPARM (sym->type) = 0;
+          processFuncArgs (sym);
+        }
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoName - the name a file scope symbol is emitted under         */
+/*-----------------------------------------------------------------*/
+const char *
+ltoName (const symbol *sym)
+{
+  if (!sym->ltoModule)
+    return sym->name;
+  return internPrintf ("__lto%d_%s", sym->ltoModule, sym->name);
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoBinding - the symbol a reference copied from an inline       */
+/*              function of another module refers to               */
+/*-----------------------------------------------------------------*/
+symbol *
+ltoBinding (const symbol *ref)
+{
+  symbol *bound = ref->ltoBind;
+  size_t len = strlen (bound->name);
+  const char *name = internFind (bound->name, len > SDCC_SYMNAME_MAX ? SDCC_SYMNAME_MAX : len);
+  bucket *bp;
+
+  /* the symbol of the same module, it may have been redeclared since */
+  if (name)
+    for (bp = SymbolTab[hashKey (name)]; bp; bp = bp->next)
+      if (bp->name == name && !bp->level && ((symbol *) bp->sym)->ltoModule == bound->ltoModule)
+        return bp->sym;
+  return bound;
+}
+
+bool
+ltoKeepDefinition (const symbol *csym)
+{
+  return combined && IFFUNC_HASBODY (csym->type);
+}
+
+bool
+ltoDropped (const symbol *func)
+{
+  return combined && !func->level && (planFor (func) & PLAN_DROP);
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoSameStruct - compares structures of different modules        */
+/*-----------------------------------------------------------------*/
+bool
+ltoSameStruct (const structdef *a, const structdef *b)
+{
+  static set *comparing;
+  const symbol *fa, *fb;
+  bool ret = TRUE;
+
+  if (!combined || !a || !b)
+    return FALSE;
+  if (a->type != b->type || a->size != b->size)
+    return FALSE;
+  if (a->tagsym && b->tagsym && a->tag != b->tag)
+    return FALSE;
+
+  /* structures referring to themselves */
+  if (isinSet (comparing, a))
+    return TRUE;
+  addSet (&comparing, (void *) a);
+
+  for (fa = a->fields, fb = b->fields; ret && fa && fb; fa = fa->next, fb = fb->next)
+    if (fa->name != fb->name || fa->offset != fb->offset || compareTypeExact (fa->type, fb->type, -1) != 1)
+      ret = FALSE;
+  if (fa || fb)
+    ret = FALSE;
+
+  deleteSetItem (&comparing, (void *) a);
+  return ret;
+}
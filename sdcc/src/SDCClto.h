@@ -0,0 +1,90 @@
+/*-------------------------------------------------------------------------
+  SDCClto.h - link-time optimization (--lto)
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#ifndef SDCCLTO_H
+#define SDCCLTO_H 1
+
+/* Compiling a source file into an object */
+
+/** Called with --lto once the preprocessor runs. Reads the preprocessed
+ *  source from yyin and replaces yyin with a copy of it. Returns TRUE,
+ *  if the source is compiled into an object for link-time optimization.
+ */
+bool ltoBeginObject (void);
+
+/** Returns TRUE while a source is compiled into an object. The functions
+ *  are summarized instead of generating code for them.
+ */
+bool ltoObjectMode (void);
+
+/** Summarizes the calls and references of the function being compiled. */
+void ltoFunction (struct ebbIndex *ebbi);
+
+/** Writes the object: the preprocessed source and its summary. */
+void ltoWriteObject (void);
+
+/* Linking */
+
+/** Returns TRUE if the file is an object for link-time optimization. */
+bool ltoIsObject (const char *name);
+
+/** Writes the source that compiles the objects as one module, with the
+ *  decisions taken for the whole program in front. The functions
+ *  referenced by the other object files are kept. Returns FALSE if an
+ *  object can't be read.
+ */
+bool ltoCombine (set *objects, set *others, const char *name);
+
+/* Compiling the combined source */
+
+/** Handles #pragma sdcc_lto in the combined source. Returns FALSE if the
+ *  arguments are wrong.
+ */
+bool ltoPragma (const char *what, int module, const char *name);
+
+/** Returns TRUE if the objects are compiled as one module. */
+bool ltoCombined (void);
+
+/** Records a declaration: marks the symbols that belong to a single module
+ *  of the combined source and applies the decisions to the functions. While
+ *  compiling an object, declarations the summary needs are recorded.
+ */
+void ltoDeclare (symbol *sym);
+
+/** The name a file scope symbol is emitted under. Static symbols of different
+ *  modules may have the same name.
+ */
+const char *ltoName (const symbol *sym);
+
+/** The file scope symbol a reference in an inline function binds to, when
+ *  the function is expanded in another module of the combined source.
+ */
+symbol *ltoBinding (const symbol *ref);
+
+/** Returns TRUE if a redeclaration of the function must not replace its
+ *  definition csym.
+ */
+bool ltoKeepDefinition (const symbol *csym);
+
+/** Returns TRUE if no code is generated for the function. */
+bool ltoDropped (const symbol *func);
+
+/** Returns TRUE if two structures from different modules are the same type. */
+bool ltoSameStruct (const structdef *a, const structdef *b);
+
+#endif
@@ -80,6 +80,9 @@ static const char *dstPath = "";          /* path for the output files; */
                                           /* "" is equivalent with cwd */
 static const char *moduleNameBase = NULL; /* module name base is source file without path and extension */
                                           /* can be NULL while linking without compiling */
+static set *srcFilesSet = NULL;           /* source files after the first one */
+static set *driverArgsSet = NULL;         /* arguments not passed on to the compiler jobs */
+static int jobs = 1;                      /* number of source files compiled at the same time */
 
 /* uncomment JAMIN_DS390 to always override and use ds390 port
   for mcs51 work.  This is temporary, for compatibility testing. */
@@ -148,11 +151,19 @@ char buffer[PATH_MAX * 2];
 #define OPTION_NO_PEEP_RETURN       "--no-peep-return"
 #define OPTION_NO_OPTSDCC_IN_ASM    "--no-optsdcc-in-asm"
 #define OPTION_MAX_ALLOCS_PER_NODE  "--max-allocs-per-node"
+#define OPTION_MAX_ALLOCS_TIME      "--max-allocs-time"
+#define OPTION_USE_PROFILE          "--use-profile"
 #define OPTION_NO_LOSPRE            "--nolospre"
 #define OPTION_ALLOW_UNSAFE_READ    "--allow-unsafe-read"
 #define OPTION_DUMP_AST             "--dump-ast"
 #define OPTION_DUMP_I_CODE          "--dump-i-code"
 #define OPTION_DUMP_GRAPHS          "--dump-graphs"
+#define OPTION_MEM_STATS            "--mem-stats"
+#define OPTION_TIME_REPORT          "--time-report"
+#define OPTION_TIME_TRACE           "--time-trace"
+#define OPTION_CACHE_DIR            "--cache-dir"
+#define OPTION_CACHE_SIZE           "--cache-size"
+#define OPTION_LTO                  "--lto"
 
 static const OPTION optionsTable[] = {
   {0,   NULL, NULL, "General options"},
@@ -172,6 +183,9 @@ static const OPTION optionsTable[] = {
   {'E', "--preprocessonly", &preProcOnly, "Preprocess only, do not compile"},
   {0,   "--c1mode", &options.c1mode, "Act in c1 mode.  The standard input is preprocessed code, the output is assembly code."},
   {'o', NULL, NULL, "Place the output into the given path resp. file"},
+  {'j', NULL, NULL, "<num> Compile that many source files at the same time"},
+  {0,   OPTION_CACHE_DIR, &options.cache_dir, "<dir> Keep the outputs of compilations in this directory and reuse them", CLAT_STRING},
+  {0,   OPTION_CACHE_SIZE, &options.cache_size, "<MiB> Size limit of the --cache-dir directory (default 1024)", CLAT_INTEGER},
   {0,   OPTION_PRINT_SEARCH_DIRS, &options.printSearchDirs, "display the directories in the compiler's search path"},
   {0,   OPTION_MSVC_ERROR_STYLE, &options.vc_err_style, "messages are compatible with Micro$oft visual studio"},
   {0,   OPTION_USE_STDOUT, NULL, "send errors to stdout instead of stderr"},
@@ -233,8 +247,11 @@ static const OPTION optionsTable[] = {
   {0,   OPTION_OPT_CODE_SPEED, NULL, "Optimize for code speed rather than size"},
   {0,   OPTION_OPT_CODE_SIZE, NULL, "Optimize for code size rather than speed"},
   {0,   OPTION_MAX_ALLOCS_PER_NODE, &options.max_allocs_per_node, "Maximum number of register assignments considered at each node of the tree decomposition", CLAT_INTEGER},
+  {0,   OPTION_MAX_ALLOCS_TIME, &options.max_allocs_time, "<ms> Choose --max-allocs-per-node for each function to fit into this time", CLAT_INTEGER},
+  {0,   OPTION_USE_PROFILE, &options.use_profile, "<file> Use execution counts recorded by the simulator instead of estimating them", CLAT_STRING},
   {0,   OPTION_NO_LOSPRE, NULL, "Disable lospre"},
   {0,   OPTION_ALLOW_UNSAFE_READ, NULL, "Allow optimizations to read any memory location anytime"},
+  {0,   OPTION_LTO, &options.lto, "Compile into objects that are optimized as a whole program when linked"},
 
   {0,   NULL, NULL, "Internal debugging options"},
   {0,   OPTION_DUMP_AST, &options.dump_ast, "Dump front-end AST before generating i-code"},
@@ -242,6 +259,9 @@ static const OPTION optionsTable[] = {
   {0,   OPTION_DUMP_GRAPHS, &options.dump_graphs, "Dump graphs (control-flow, conflict, etc)"},
   {0,   OPTION_ICODE_IN_ASM, &options.iCodeInAsm, "Include i-code as comments in the asm file"},
   {0,   OPTION_VERBOSE_ASM, &options.verboseAsm, "Include code generator comments in the asm output"},
+  {0,   OPTION_MEM_STATS, &options.mem_stats, "Print memory arena statistics"},
+  {0,   OPTION_TIME_REPORT, &options.time_report, "Print the compile time spent in each pass and function"},
+  {0,   OPTION_TIME_TRACE, &options.time_trace, "<file> write pass timings in Chrome trace format", CLAT_STRING},
 
   {0,   NULL, NULL, "Linker options"},
   {'l', NULL, NULL, "Include the given library in the link"},
@@ -614,6 +634,7 @@ setDefaultOptions (void)
   options.stack10bit = 0;
   options.out_fmt = 0;
   options.dump_graphs = 0;
+  options.cache_size = 1024;    /* MiB */
   options.dependencyFileOpt = 0;
 
   /* now for the optimizations */
@@ -667,11 +688,10 @@ processFile (char *s)
 
       dbuf_destroy (&ext);
 
-      /* source file name : not if we already have a
-         source file */
+      /* further source files are compiled by compileSources () */
       if (fullSrcFileName)
         {
-          werror (W_TOO_MANY_SRC, s);
+          addSet (&srcFilesSet, s);
 
           dbuf_destroy (&path);
 
@@ -1277,13 +1297,20 @@ parseCmdLine (int argc, char **argv)
               break;
 
             case 'l':
+              addSet (&driverArgsSet, argv[i]);
               addSet (&libFilesSet, Safe_strdup (getStringArg ("-l", argv, &i, argc)));
+              addSet (&driverArgsSet, argv[i]);
               break;
 
             case 'o':
               {
-                char *outName = getStringArg ("-o", argv, &i, argc);
-                size_t len = strlen (outName);
+                char *outName;
+                size_t len;
+
+                addSet (&driverArgsSet, argv[i]);
+                outName = getStringArg ("-o", argv, &i, argc);
+                addSet (&driverArgsSet, argv[i]);
+                len = strlen (outName);
 
                 /* point to last character */
                 if (IS_DIR_SEPARATOR (outName[len - 1]))
@@ -1314,6 +1341,17 @@ parseCmdLine (int argc, char **argv)
                 break;
               }
 
+            case 'j':
+              addSet (&driverArgsSet, argv[i]);
+              jobs = getIntArg ("-j", argv, &i, argc);
+              addSet (&driverArgsSet, argv[i]);
+              if (jobs < 1)
+                {
+                  werror (E_BAD_INT_ARGUMENT, "-j");
+                  exit (EXIT_FAILURE);
+                }
+              break;
+
             case 'W':
               /* pre-processer options */
               if (argv[i][2] == 'p')
@@ -1429,6 +1467,7 @@ parseCmdLine (int argc, char **argv)
         }
       else
         {
+          addSet (&driverArgsSet, argv[i]);
           processFile (argv[i]);
         }
     }
@@ -1444,6 +1483,10 @@ parseCmdLine (int argc, char **argv)
           werror (W_NO_FILE_ARG_IN_C1, fullSrcFileName);
         }
       fullSrcFileName = NULL;
+      for (s = setFirstItem (srcFilesSet); s != NULL; s = setNextItem (srcFilesSet))
+        {
+          werror (W_NO_FILE_ARG_IN_C1, s);
+        }
       for (s = setFirstItem (relFilesSet); s != NULL; s = setNextItem (relFilesSet))
         {
           werror (W_NO_FILE_ARG_IN_C1, s);
@@ -1452,6 +1495,7 @@ parseCmdLine (int argc, char **argv)
         {
           werror (W_NO_FILE_ARG_IN_C1, s);
         }
+      deleteSet (&srcFilesSet);
       deleteSet (&relFilesSet);
       deleteSet (&libFilesSet);
 
@@ -1476,6 +1520,13 @@ parseCmdLine (int argc, char **argv)
           moduleName = m;
         }
     }
+  /* each source file gets its own output file */
+  if (srcFilesSet && fullDstFileName && (options.cc_only || noAssemble || preProcOnly))
+    {
+      werror (E_OPT_O_WITH_SRC_FILES);
+      exit (EXIT_FAILURE);
+    }
+
   /* if no dstFileName given with -o, we've to find one: */
   if (!dstFileName)
     {
@@ -1564,6 +1615,12 @@ finalizeOptions (void)
   /* no peephole comments if not verbose asm */
   if (!options.verboseAsm)
     options.noPeepComments = 1;
+
+  if (options.lto && TARGET_PIC_LIKE)
+    {
+      werror (W_LTO_UNSUPPORTED, port->target);
+      options.lto = 0;
+    }
 }
 
 static const char *
@@ -1583,6 +1640,150 @@ getOutFmtExt (void)
     }
 }
 
+/*-----------------------------------------------------------------*/
+/* appendCompilerArgs - appends the command line without the files */
+/*                      and the arguments of the driver            */
+/*-----------------------------------------------------------------*/
+static void
+appendCompilerArgs (struct dbuf_s *cmd, int argc, char **argv)
+{
+  char *arg;
+  int i;
+
+  for (i = 0; i < argc; i++)
+    {
+      if (i && (argv[i] == fullSrcFileName || isinSet (srcFilesSet, argv[i]) || isinSet (driverArgsSet, argv[i])))
+        continue;
+      arg = shell_escape (argv[i]);
+      dbuf_printf (cmd, i ? " %s" : "%s", arg);
+      Safe_free (arg);
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* startCompile - starts a compiler job for one of several sources */
+/*-----------------------------------------------------------------*/
+static FILE *
+startCompile (const char *s, int argc, char **argv)
+{
+  struct dbuf_s cmd;
+  FILE *fp;
+  char *arg;
+
+  /* the same command line, but with this source file only */
+  dbuf_init (&cmd, PATH_MAX);
+  appendCompilerArgs (&cmd, argc, argv);
+
+  /* the objects are linked here */
+  if (!options.cc_only && !noAssemble && !preProcOnly)
+    dbuf_append_str (&cmd, " -c");
+  if (*dstPath)
+    {
+      struct dbuf_s path;
+
+      dbuf_init (&path, PATH_MAX);
+      dbuf_makePath (&path, dstPath, NULL);
+      arg = shell_escape (dbuf_c_str (&path));
+      dbuf_printf (&cmd, " -o %s", arg);
+      Safe_free (arg);
+      dbuf_destroy (&path);
+    }
+  arg = shell_escape (s);
+  dbuf_printf (&cmd, " %s", arg);
+  Safe_free (arg);
+
+  /* collect the messages, the preprocessed source goes to stdout */
+  if (!preProcOnly)
+    dbuf_append_str (&cmd, " 2>&1");
+
+  if (options.verbose)
+    printf ("sdcc: %s\n", dbuf_c_str (&cmd));
+  if (!(fp = sdcc_popen (dbuf_c_str (&cmd))))
+    perror ("sdcc");
+
+  dbuf_destroy (&cmd);
+  return fp;
+}
+
+/*-----------------------------------------------------------------*/
+/* compileSources - compiles several source files in -j jobs       */
+/*-----------------------------------------------------------------*/
+static void
+compileSources (int argc, char **argv)
+{
+  FILE *out = preProcOnly ? stdout : stderr;
+  set *srcs = NULL;
+  FILE **fps;
+  const char *s;
+  char buf[4096];
+  int nsrcs, started, done;
+  bool failed = FALSE;
+  size_t len;
+
+  /* the first one was opened by processFile () */
+  fclose (srcFile);
+  srcFile = NULL;
+
+  addSet (&srcs, (void *) fullSrcFileName);
+  for (s = setFirstItem (srcFilesSet); s; s = setNextItem (srcFilesSet))
+    addSet (&srcs, (void *) s);
+  nsrcs = elementsInSet (srcs);
+  fps = Safe_alloc (nsrcs * sizeof (FILE *));
+
+  /* keep up to -j jobs running, but pass on their
+     messages in the order of the source files */
+  s = setFirstItem (srcs);
+  for (started = done = 0; done < nsrcs; done++)
+    {
+      for (; started < nsrcs && started - done < jobs; started++, s = setNextItem (srcs))
+        fps[started] = startCompile (s, argc, argv);
+      fflush (stdout);
+
+      if (!fps[done])
+        {
+          failed = TRUE;
+          continue;
+        }
+      while ((len = fread (buf, 1, sizeof (buf), fps[done])) != 0)
+        fwrite (buf, 1, len, out);
+      fflush (out);
+      if (sdcc_pclose (fps[done]))
+        failed = TRUE;
+    }
+  Safe_free (fps);
+
+  if (failed)
+    exit (EXIT_FAILURE);
+
+  /* link the objects in the order of the sources */
+  if (!options.cc_only && !noAssemble && !preProcOnly)
+    {
+      set *rels = NULL;
+
+      for (s = setFirstItem (srcs); s; s = setNextItem (srcs))
+        {
+          struct dbuf_s base;
+          struct dbuf_s path;
+
+          dbuf_init (&base, PATH_MAX);
+          dbuf_init (&path, PATH_MAX);
+          dbuf_splitFile (s, &path, NULL);
+          dbuf_splitPath (dbuf_c_str (&path), NULL, &base);
+          dbuf_set_length (&path, 0);
+          if (*dstPath)
+            dbuf_makePath (&path, dstPath, dbuf_c_str (&base));
+          else
+            dbuf_append_str (&path, dbuf_c_str (&base));
+          dbuf_append_str (&path, port->linker.rel_ext);
+          addSet (&rels, dbuf_detach_c_str (&path));
+          dbuf_destroy (&base);
+        }
+      mergeSets (&rels, relFilesSet);
+      relFilesSet = rels;
+    }
+  deleteSet (&srcs);
+}
+
 /*-----------------------------------------------------------------*/
 /* linkEdit : - calls the linkage editor  with options             */
 /*-----------------------------------------------------------------*/
@@ -1955,6 +2156,126 @@ assemble (char **envp)
     }
 }
 
+/*-----------------------------------------------------------------*/
+/* ltoCompileSource - compiles a combined source into dstFileName  */
+/*-----------------------------------------------------------------*/
+static int
+ltoCompileSource (const char *src, int argc, char **argv)
+{
+  struct dbuf_s cmd, asmName;
+  char *arg;
+  int ret;
+
+  dbuf_init (&cmd, PATH_MAX);
+  appendCompilerArgs (&cmd, argc, argv);
+  dbuf_init (&asmName, PATH_MAX);
+  dbuf_printf (&asmName, "%s%s", dstFileName, port->assembler.file_ext);
+  arg = shell_escape (dbuf_c_str (&asmName));
+  dbuf_printf (&cmd, " --c1mode -o %s", arg);
+  Safe_free (arg);
+  dbuf_destroy (&asmName);
+  arg = shell_escape (src);
+  dbuf_printf (&cmd, " < %s", arg);
+  Safe_free (arg);
+
+  if (options.verbose)
+    printf ("sdcc: %s\n", dbuf_c_str (&cmd));
+  ret = sdcc_system (dbuf_c_str (&cmd));
+  dbuf_destroy (&cmd);
+  return ret;
+}
+
+/*-----------------------------------------------------------------*/
+/* ltoCompile - compiles the objects of --lto as one module        */
+/*-----------------------------------------------------------------*/
+static void
+ltoCompile (int argc, char **argv, char **envp)
+{
+  const char *savedDstFileName = dstFileName;
+  set *objects = NULL;
+  set *others = NULL;
+  set *rels = NULL;
+  char *mainRel = NULL;
+  struct dbuf_s base, src, path;
+  const char *s;
+
+  /* the object of the source file is linked too */
+  if (fullSrcFileName)
+    {
+      dbuf_init (&path, PATH_MAX);
+      dbuf_printf (&path, "%s%s", dstFileName, port->linker.rel_ext);
+      mainRel = dbuf_detach_c_str (&path);
+      addSet (ltoIsObject (mainRel) ? &objects : &others, mainRel);
+    }
+  for (s = setFirstItem (relFilesSet); s; s = setNextItem (relFilesSet))
+    addSet (ltoIsObject (s) ? &objects : &others, (void *) s);
+  if (!objects)
+    {
+      Safe_free (mainRel);
+      deleteSet (&others);
+      return;
+    }
+  if (mainRel)
+    {
+      addSetHead (&relFilesSet, mainRel);
+      fullSrcFileName = NULL;
+    }
+
+  dbuf_init (&base, PATH_MAX);
+  dbuf_printf (&base, "%s_lto", dstFileName);
+  dbuf_init (&src, PATH_MAX);
+  dbuf_printf (&src, "%s.c", dbuf_c_str (&base));
+  if (!ltoCombine (objects, others, dbuf_c_str (&src)))
+    exit (EXIT_FAILURE);
+
+  if (options.verbose)
+    printf ("sdcc: Compiling the whole program...\n");
+
+  /* the objects are replaced by what they compile to, in the place of the first */
+  dstFileName = dbuf_c_str (&base);
+  if (!ltoCompileSource (dbuf_c_str (&src), argc, argv))
+    {
+      assemble (envp);
+      dbuf_init (&path, PATH_MAX);
+      dbuf_printf (&path, "%s%s", dstFileName, port->linker.rel_ext);
+      for (s = setFirstItem (relFilesSet); s; s = setNextItem (relFilesSet))
+        if (s == peekSet (objects))
+          addSet (&rels, dbuf_detach_c_str (&path));
+        else if (!isinSet (objects, s))
+          addSet (&rels, (void *) s);
+    }
+  else
+    {
+      int n = 0;
+
+      /* compile each object on its own */
+      werror (W_LTO_FAILED);
+      for (s = setFirstItem (relFilesSet); s; s = setNextItem (relFilesSet))
+        {
+          if (!isinSet (objects, s))
+            {
+              addSet (&rels, (void *) s);
+              continue;
+            }
+          dbuf_init (&path, PATH_MAX);
+          dbuf_printf (&path, "%s%d", dbuf_c_str (&base), ++n);
+          dstFileName = dbuf_c_str (&path);
+          if (ltoCompileSource (s, argc, argv))
+            exit (EXIT_FAILURE);
+          assemble (envp);
+          dbuf_printf (&path, "%s", port->linker.rel_ext);
+          addSet (&rels, dbuf_detach_c_str (&path));
+        }
+    }
+  deleteSet (&relFilesSet);
+  relFilesSet = rels;
+  deleteSet (&objects);
+  deleteSet (&others);
+  dbuf_destroy (&src);
+  dbuf_destroy (&base);
+  dstFileName = savedDstFileName;
+}
+
 /*-----------------------------------------------------------------*/
 /* preProcess - spawns the preprocessor with arguments             */
 /*-----------------------------------------------------------------*/
@@ -2590,29 +2911,44 @@ main (int argc, char **argv, char **envp)
   /* finalize common options */
   finalizeOptions ();
 
-  if (fullSrcFileName || options.c1mode)
+  if (srcFilesSet)
     {
-      preProcess (envp);
+      compileSources (argc, argv);
+      fullSrcFileName = NULL;
+    }
+
+  if (fullSrcFileName || options.c1mode)
+    preProcess (envp);
 
+  if ((fullSrcFileName || options.c1mode) && (ltoBeginObject () || !cacheRestore (argc, argv)))
+    {
       initSymt ();
       initiCode ();
       initCSupport ();
       initBuiltIns ();
       initPeepHole ();
 
+      if (options.use_profile)
+        readProfile (options.use_profile);
+
       if (options.verbose)
         printf ("sdcc: Generating code...\n");
 
+      timerBegin ("parse");
       yyparse ();
+      timerEnd ("parse");
 
       if (!options.c1mode)
-        if (sdcc_pclose (yyin))
+        if (cacheMiss () || ltoObjectMode () ? fclose (yyin) : sdcc_pclose (yyin))
           fatalError = 1;
 
       if (fatalError)
         exit (EXIT_FAILURE);
 
-      if (port->general.do_glue != NULL)
+      timerBegin ("glue");
+      if (ltoObjectMode ())
+        ltoWriteObject ();
+      else if (port->general.do_glue != NULL)
         (*port->general.do_glue) ();
       else
         {
@@ -2621,11 +2957,21 @@ main (int argc, char **argv, char **envp)
           /* in case of NDEBUG */
           glue ();
         }
+      timerEnd ("glue");
 
       if (fatalError)
         exit (EXIT_FAILURE);
 
-      if (!options.c1mode && !noAssemble)
+      if (options.mem_stats)
+        printMemStats (stderr);
+
+      if (options.time_report)
+        timerReport (stderr);
+
+      if (options.time_trace)
+        timerWriteTrace (options.time_trace);
+
+      if (!options.c1mode && !noAssemble && !ltoObjectMode ())
         {
           if (options.verbose)
             printf ("sdcc: Calling assembler...\n");
@@ -2637,8 +2983,13 @@ main (int argc, char **argv, char **envp)
   if (options.debug && debugFile)
     debugFile->closeFile ();
 
+  cacheStore ();
+
   if (!options.cc_only && !fatalError && !noAssemble && !options.c1mode && (fullSrcFileName || peekSet (relFilesSet) != NULL))
     {
+      if (!TARGET_PIC_LIKE)
+        ltoCompile (argc, argv, envp);
+
       if (options.verbose)
         printf ("sdcc: Calling linker...\n");
 
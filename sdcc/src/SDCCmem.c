@@ -510,8 +510,7 @@ allocGlobal (symbol * sym)
 {
   /* symbol name is internal name  */
   if (!sym->level)              /* local statics can come here */
-    SNPRINTF (sym->rname, sizeof(sym->rname),
-              "%s%s", port->fun_prefix, sym->name);
+    sym->rname = internPrintf ("%s%s", port->fun_prefix, ltoName (sym));
 
   /* add it to the operandKey reset */
   if (!isinSet (operKeyReset, sym))
@@ -688,8 +687,7 @@ allocParms (value *val, bool smallc)
 
           /* allocate them in the automatic space */
           /* generate a unique name  */
-          SNPRINTF (lval->sym->rname, sizeof(lval->sym->rname),
-                    "%s%s_PARM_%d", port->fun_prefix, currFunc->name, pNum);
+          lval->sym->rname = internPrintf ("%s%s_PARM_%d", port->fun_prefix, ltoName (currFunc), pNum);
           strncpyz (lval->name, lval->sym->rname, sizeof(lval->name));
 
           /* if declared in specific storage */
@@ -758,14 +756,12 @@ deallocParms (value * val)
       /* and leave a copy of it in the symbol table           */
       if (lval->sym->rname[0])
         {
-          char buffer[SDCC_NAME_MAX];
           symbol * argsym = lval->sym;
+          size_t len = strlen (argsym->rname);
 
-          strncpyz (buffer, lval->sym->rname, sizeof(buffer));
           lval->sym = copySymbol (lval->sym);
-          strncpyz (lval->sym->rname, buffer, sizeof(lval->sym->rname));
 
-          strncpyz (lval->sym->name, buffer, sizeof(lval->sym->name));
+          lval->sym->name = internStrn (argsym->rname, len > SDCC_SYMNAME_MAX ? SDCC_SYMNAME_MAX : len);
           /* need to keep the original name for inlining to work */
           /*strncpyz (lval->name, buffer, sizeof(lval->name)); */
 
@@ -791,10 +787,9 @@ void
 allocLocal (symbol * sym)
 {
   /* generate an unique name */
-  SNPRINTF (sym->rname, sizeof(sym->rname),
-            "%s%s_%s_%d_%d",
-            port->fun_prefix,
-            currFunc->name, sym->name, sym->level, sym->block);
+  sym->rname = internPrintf ("%s%s_%s_%d_%d",
+                             port->fun_prefix,
+                             ltoName (currFunc), sym->name, sym->level, sym->block);
 
   sym->islocal = 1;
   sym->localof = currFunc;
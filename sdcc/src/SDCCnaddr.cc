@@ -76,6 +76,11 @@ switchAddressSpacesOptimally (iCode *ic, ebbIndex *ebbi)
   if(options.dump_graphs)
     dump_tree_decomposition_naddr(tree_decomposition);
 
-  return(tree_dec_address_switch(tree_decomposition, control_flow_graph, addrspaces));
+  static allocs_budget budget("address space switching", 0.15, 10000000);
+  budget.begin(tree_decomposition);
+  int ret = tree_dec_address_switch(tree_decomposition, control_flow_graph, addrspaces);
+  budget.end();
+
+  return(ret);
 }
 
@@ -46,6 +46,7 @@
 #include <boost/graph/graphviz.hpp>
 
 #include "SDCCtree_dec.hpp"
+#include "SDCCbudget.hpp"
 
 extern "C"
 {
@@ -975,7 +975,7 @@ convbuiltin (iCode *const ic, eBBlock *ebp)
       /* TODO: Eliminate it, convert any SEND of volatile into DUMMY_READ_VOLATILE. */
       /* For now just convert back to call to make sure any volatiles are read. */
 
-      strcpy(OP_SYMBOL (IC_LEFT (icc))->rname, !strcmp (bif->name, "__builtin_memcpy") ? "_memcpy" : (!strcmp (bif->name, "__builtin_strncpy") ? "_strncpy" : "_memset"));
+      OP_SYMBOL (IC_LEFT (icc))->rname = internStr (!strcmp (bif->name, "__builtin_memcpy") ? "_memcpy" : (!strcmp (bif->name, "__builtin_strncpy") ? "_strncpy" : "_memset"));
       goto convert;
     }
 
@@ -985,7 +985,7 @@ convbuiltin (iCode *const ic, eBBlock *ebp)
       if (bitVectIsZero (OP_USES (IC_RESULT (icc))) && IS_OP_LITERAL (IC_LEFT (lastparam)))
         return;
       
-      strcpy(OP_SYMBOL (IC_LEFT (icc))->rname, !strcmp (bif->name, "__builtin_memcpy") ? "_memcpy" : (!strcmp (bif->name, "__builtin_strncpy") ? "_strncpy" : "_memset"));
+      OP_SYMBOL (IC_LEFT (icc))->rname = internStr (!strcmp (bif->name, "__builtin_memcpy") ? "_memcpy" : (!strcmp (bif->name, "__builtin_strncpy") ? "_strncpy" : "_memset"));
       goto convert;
     }
   
@@ -1750,9 +1750,11 @@ killDeadCode (ebbIndex * ebbi)
   /*     or then skip                                            */
   /*     else            KILL                                    */
   /* this whole process is carried on iteratively till no change */
+  timerBegin ("killDeadCode");
   do
     {
       change = 0;
+      timerAddCount ("killDeadCode", 1);
       /* for all blocks do */
       for (i = 0; i < count; i++)
         {
@@ -1930,6 +1932,8 @@ killDeadCode (ebbIndex * ebbi)
     }                           /* end of do */
   while (change);
 
+  timerEnd ("killDeadCode");
+
   return gchange;
 }
 
@@ -2711,6 +2715,14 @@ void guessCounts (iCode *start_ic, ebbIndex *ebbi)
   int i;
   bool needprop;
 
+  timerBegin ("guessCounts");
+
+  if (options.use_profile && profileCounts (start_ic))
+    {
+      timerEnd ("guessCounts");
+      return;
+    }
+
   for (ic = start_ic; ic; ic = ic->next)
     ic->count = 0;
   start_ic->pcount = 1.0f;
@@ -2768,6 +2780,9 @@ void guessCounts (iCode *start_ic, ebbIndex *ebbi)
           ic->pcount = 0.0f;
         }
     }
+
+  timerAddCount ("guessCounts", i);
+  timerEnd ("guessCounts");
 }
 
 /*-----------------------------------------------------------------*/
@@ -2907,7 +2922,9 @@ eBBlockFromiCode (iCode *ic)
   guessCounts (ic, ebbi);
   if (optimize.lospre && (TARGET_Z80_LIKE || TARGET_HC08_LIKE || TARGET_IS_STM8)) /* Todo: enable for other ports. */
     {
+      timerBegin ("lospre");
       lospre (ic, ebbi);
+      timerEnd ("lospre");
       if (options.dump_i_code)
         dumpEbbsToFileExt (DUMP_LOSPRE, ebbi);
 
@@ -2945,8 +2962,10 @@ eBBlockFromiCode (iCode *ic)
      (but assume that it can happen in other functions) */
   adjustIChain (ebbi->bbOrder, ebbi->count);
   ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbi->bbOrder, ebbi->count));
+  timerBegin ("switchAddressSpaces");
   if (!currFunc || switchAddressSpacesOptimally (ic, ebbi))
     switchAddressSpaces (ic); /* Fallback. Very unlikely to be triggered, unless --max-allocs-per-node is set to very small values or very weird control-flow graphs */
+  timerEnd ("switchAddressSpaces");
 
   /* Break down again and redo some steps to not confuse live range analysis. */
   ebbi = iCodeBreakDown (ic);
@@ -3001,8 +3020,16 @@ eBBlockFromiCode (iCode *ic)
    */
   discardDeadParamReceives (ebbi->bbOrder, ebbi->count);
 
-  /* allocate registers & generate code */
-  port->assignRegisters (ebbi);
+  /* allocate registers & generate code, an object for --lto only
+     records what the function calls and references */
+  if (ltoObjectMode ())
+    ltoFunction (ebbi);
+  else
+    {
+      timerBegin ("assignRegisters");
+      port->assignRegisters (ebbi);
+      timerEnd ("assignRegisters");
+    }
 
   /* throw away blocks */
   setToNull ((void *) &graphEdges);
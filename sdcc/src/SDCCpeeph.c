@@ -2639,6 +2639,7 @@ peepHole (lineNode ** pls)
   peepRule *pr;
   lineNode *mtail = NULL;
   bool restart, replaced;
+  long tries = 0, matches = 0;
 
 #if !OPT_DISABLE_PIC14 || !OPT_DISABLE_PIC16
   /* The PIC port uses a different peep hole optimizer based on "pCode" */
@@ -2648,9 +2649,12 @@ peepHole (lineNode ** pls)
 
   assert(labelHash == NULL);
 
+  timerBegin ("peepHole");
+
   do
     {
       restart = FALSE;
+      timerAddCount ("peepHole", 1);
 
       /* for all rules */
 
@@ -2677,8 +2681,11 @@ peepHole (lineNode ** pls)
               /* Tidy up any data stored in the hTab */
 
               /* if it matches */
+              tries++;
               if (matchRule (spl, &mtail, pr, *pls))
                 {
+                  matches++;
+
                   /* restart at the replaced line */
                   replaced = TRUE;
 
@@ -2719,6 +2726,10 @@ peepHole (lineNode ** pls)
       freeTrace (&_G.labels);
     }
   labelHash = NULL;
+
+  timerCount ("peephole rule tries", tries);
+  timerCount ("peephole rule matches", matches);
+  timerEnd ("peepHole");
 }
 
 
@@ -0,0 +1,152 @@
+/*-------------------------------------------------------------------------
+  SDCCprofile.c - execution counts recorded by the simulator (--use-profile)
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+/* A profile is obtained in three steps:
+   - The program is compiled with --debug. The code generators then emit
+     a probe symbol P$module$function$id at the function entry, at every
+     label and behind every conditional jump. The linker writes their
+     addresses into the .cdb file.
+   - The simulator counts how often each instruction is executed. Its
+     "profile save" command looks up the probe addresses in the .cdb file
+     and writes one line "probe count" per probe.
+   - The program is compiled again with --use-profile. The counts then
+     replace the estimate of guessCounts ().
+   Labels and conditional jumps are identified by their keys. These are
+   assigned before the counts are used for the first time, so the probes
+   match as long as the source and all other options stay the same. */
+
+#include "common.h"
+#include "dbuf_string.h"
+
+static hTab *profileTab;
+
+/*-----------------------------------------------------------------*/
+/* readProfile - reads the probe counts for --use-profile          */
+/*-----------------------------------------------------------------*/
+void
+readProfile (const char *fileName)
+{
+  FILE *f;
+  struct dbuf_s line;
+
+  if (!(f = fopen (fileName, "r")))
+    {
+      werror (E_FILE_OPEN_ERR, fileName);
+      return;
+    }
+
+  dbuf_init (&line, 128);
+  while (dbuf_getline (&line, f))
+    {
+      char *name = (char *) dbuf_c_str (&line);
+      char *count;
+
+      name += strspn (name, " \t");
+      count = name + strcspn (name, " \t\r\n");
+      if (count != name && *count && *count != '\n' && *count != '\r')
+        {
+          *count++ = '\0';
+          shash_add (&profileTab, name, count);
+        }
+      dbuf_set_length (&line, 0);
+    }
+  dbuf_destroy (&line);
+
+  fclose (f);
+}
+
+/*-----------------------------------------------------------------*/
+/* probeName - name of the probe in front of ic, NULL if none      */
+/*-----------------------------------------------------------------*/
+static const char *
+probeName (const iCode *ic)
+{
+  static char name[INITIAL_INLINEASM];
+
+  if (!currFunc)
+    return NULL;
+
+  if (ic->op == FUNCTION)
+    SNPRINTF (name, sizeof (name), "P$%s$%s$E", moduleName, currFunc->name);
+  else if (ic->op == LABEL)
+    SNPRINTF (name, sizeof (name), "P$%s$%s$L%d", moduleName, currFunc->name, IC_LABEL (ic)->key);
+  else if (ic->prev && ic->prev->op == IFX)
+    SNPRINTF (name, sizeof (name), "P$%s$%s$F%d", moduleName, currFunc->name, ic->prev->key);
+  else
+    return NULL;
+
+  return name;
+}
+
+/*-----------------------------------------------------------------*/
+/* emitProfileProbe - marks the start of a block in the .cdb file  */
+/*-----------------------------------------------------------------*/
+void
+emitProfileProbe (const iCode *ic)
+{
+  const char *name;
+
+  if (!options.debug)
+    return;
+
+  if ((name = probeName (ic)))
+    emitDebuggerSymbol (name);
+}
+
+/*-----------------------------------------------------------------*/
+/* probeCount - recorded count of the probe in front of ic         */
+/*-----------------------------------------------------------------*/
+static bool
+probeCount (const iCode *ic, float *count)
+{
+  const char *name = probeName (ic);
+  const char *value;
+
+  if (!name || !(value = shash_find (profileTab, name)))
+    return FALSE;
+
+  *count = (float) strtod (value, NULL);
+  return TRUE;
+}
+
+/*-----------------------------------------------------------------*/
+/* profileCounts - sets ic->count from the profile                 */
+/*-----------------------------------------------------------------*/
+int
+profileCounts (iCode *start_ic)
+{
+  iCode *ic;
+  float calls, count;
+
+  /* The function may start with its entry label. */
+  for (ic = start_ic; ic && ic->op != FUNCTION; ic = ic->next)
+    ;
+  if (!profileTab || !ic || !probeCount (ic, &calls))
+    return 0;
+
+  /* Blocks that have no probe, e.g. code added by lospre, inherit
+     the count of the code in front of them. */
+  count = calls;
+  for (ic = start_ic; ic; ic = ic->next)
+    {
+      probeCount (ic, &count);
+      ic->count = calls > 0 ? count / calls : 0;
+    }
+
+  return 1;
+}
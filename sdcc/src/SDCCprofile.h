@@ -0,0 +1,39 @@
+/*-------------------------------------------------------------------------
+  SDCCprofile.h - execution counts recorded by the simulator (--use-profile)
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#ifndef SDCCPROFILE_H
+#define SDCCPROFILE_H 1
+
+/** Reads a profile written by the simulator's "profile save" command.
+ *  Each line holds a probe name and its execution count.
+ */
+void readProfile (const char *fileName);
+
+/** With --debug, emits a probe symbol if ic starts a block whose
+ *  execution count --use-profile needs. Called by the code generators
+ *  before generating code for ic.
+ */
+void emitProfileProbe (const iCode *ic);
+
+/** Sets the count of all iCodes of the function from the profile,
+ *  relative to the number of calls like guessCounts () does.
+ *  Returns 0 if the profile has no data for the current function.
+ */
+int profileCounts (iCode *start_ic);
+
+#endif
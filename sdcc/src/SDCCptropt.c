@@ -404,7 +404,7 @@ ptrPseudoSymConvert (symbol * sym, iCode * dic, const char *name)
   psym->type = sym->type;
   psym->etype = psym->psbase->etype;
 
-  strcpy (psym->rname, psym->name);
+  psym->rname = psym->name;
   sym->isspilt = 1;
   sym->usl.spillLoc = psym;
 #if 0                           // an alternative fix for bug #480076
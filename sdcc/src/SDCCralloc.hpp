@@ -65,6 +65,7 @@
 
 #include "common.h"
 #include "SDCCtree_dec.hpp"
+#include "SDCCbudget.hpp"
 
 extern "C"
 {
@@ -188,6 +189,12 @@ struct tree_dec_node
   unsigned weight; // The weight is the number of nodes at which intermediate results need to be remembered. In general, to minimize memory consumption, at join nodes the child with maximum weight should be processed first.
 };
 
+// Assignments hold the variables alive at a node, see allocs_budget.
+inline size_t budget_node_width(const tree_dec_node &n)
+{
+  return(n.alive.size());
+}
+
 typedef boost::container::flat_multimap<int, var_t> operand_map_t; // Faster than std::multimap<int, var_t> and stx::btree_multimap<int, var_t> here.
 
 struct cfg_node
@@ -1119,6 +1126,9 @@ static void tree_dec_ralloc_nodes(T_t &T, typename boost::graph_traits<T_t>::ver
       std::cerr << "Not nice.\n";
       break;
     }
+
+  timerCount ("ralloc2 nodes", 1);
+  timerCount ("ralloc2 assignments", T[t].assignments.size());
 }
 
 // Find the best root selecting from t_old and the leafs under t.
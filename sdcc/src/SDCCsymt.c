@@ -87,12 +87,12 @@ nounName (sym_link * sl)
   return "unknown";
 }
 
-bucket *SymbolTab[256];         /* the symbol    table  */
-bucket *StructTab[256];         /* the structure table  */
-bucket *TypedefTab[256];        /* the typedef   table  */
-bucket *LabelTab[256];          /* the Label     table  */
-bucket *enumTab[256];           /* enumerated    table  */
-bucket *AddrspaceTab[256];      /* the named address space table  */
+bucket *SymbolTab[HASHTAB_SIZE];        /* the symbol    table  */
+bucket *StructTab[HASHTAB_SIZE];        /* the structure table  */
+bucket *TypedefTab[HASHTAB_SIZE];       /* the typedef   table  */
+bucket *LabelTab[HASHTAB_SIZE];         /* the Label     table  */
+bucket *enumTab[HASHTAB_SIZE];          /* enumerated    table  */
+bucket *AddrspaceTab[HASHTAB_SIZE];     /* the named address space table  */
 
 /*------------------------------------------------------------------*/
 /* initSymt () - initialises symbol table related stuff             */
@@ -102,7 +102,7 @@ initSymt (void)
 {
   int i = 0;
 
-  for (i = 0; i < 256; i++)
+  for (i = 0; i < HASHTAB_SIZE; i++)
     SymbolTab[i] = StructTab[i] = (void *) NULL;
 }
 
@@ -114,32 +114,52 @@ newBucket (void)
 {
   bucket *bp;
 
-  bp = Safe_alloc (sizeof (bucket));
+  bp = Global_alloc (sizeof (bucket));
 
   return bp;
 }
 
 /*-----------------------------------------------------------------*/
-/* hashKey - computes the hashkey given a symbol name              */
+/* hashKey - computes the hashkey given an interned symbol name    */
 /*-----------------------------------------------------------------*/
 int
 hashKey (const char *s)
 {
-  unsigned long key = 0;
+  /* hash the contents, not the address: the chain order must not
+     depend on where the heap happens to be */
+  return (int) (internHashOf (s) & (HASHTAB_SIZE - 1));
+}
+
+/*-----------------------------------------------------------------*/
+/* tabName - returns the interned name a symbol table entry for    */
+/*           sname would have, NULL if there can be none           */
+/*-----------------------------------------------------------------*/
+static const char *
+tabName (const char *sname)
+{
+  size_t len = strlen (sname);
 
-  while (*s)
-    key += *s++;
-  return key % 256;
+  return internFind (sname, len > SDCC_SYMNAME_MAX ? SDCC_SYMNAME_MAX : len);
+}
+
+/*-----------------------------------------------------------------*/
+/* symTabName - same as tabName for an interned symbol name        */
+/*-----------------------------------------------------------------*/
+static const char *
+symTabName (const char *name)
+{
+  return strlen (name) > SDCC_SYMNAME_MAX ? tabName (name) : name;
 }
 
 /*-----------------------------------------------------------------*/
 /* addSym - adds a symbol to the hash Table                        */
 /*-----------------------------------------------------------------*/
 void
-addSym (bucket ** stab, void *sym, char *sname, int level, int block, int checkType)
+addSym (bucket ** stab, void *sym, const char *sname, int level, int block, int checkType)
 {
   int i;                        /* index into the hash Table */
   bucket *bp;                   /* temp bucket    *          */
+  size_t len;
 
   if (checkType)
     {
@@ -153,22 +173,24 @@ addSym (bucket ** stab, void *sym, char *sname, int level, int block, int checkT
       checkTypeSanity (csym->etype, csym->name);
     }
 
-  /* prevent overflow of the (r)name buffers */
-  if (strlen (sname) > SDCC_SYMNAME_MAX)
+  /* the names in the tables are limited to SDCC_SYMNAME_MAX */
+  len = strlen (sname);
+  if (len > SDCC_SYMNAME_MAX)
     {
       werror (W_SYMBOL_NAME_TOO_LONG, SDCC_SYMNAME_MAX);
-      sname[SDCC_SYMNAME_MAX] = '\0';
+      len = SDCC_SYMNAME_MAX;
     }
 
-  /* the symbols are always added at the head of the list  */
-  i = hashKey (sname);
   /* get a free entry */
-  bp = Safe_alloc (sizeof (bucket));
+  bp = Global_alloc (sizeof (bucket));
 
   bp->sym = sym;                /* update the symbol pointer */
   bp->level = level;            /* update the nest level     */
   bp->block = block;
-  strncpyz (bp->name, sname, sizeof (bp->name));        /* copy the name into place */
+  bp->name = internStrn (sname, len);
+
+  /* the symbols are always added at the head of the list  */
+  i = hashKey (bp->name);
 
   /* if this is the first entry */
   if (stab[i] == NULL)
@@ -195,6 +217,8 @@ deleteSym (bucket ** stab, void *sym, const char *sname)
   int i = 0;
   bucket *bp;
 
+  if (!(sname = tabName (sname)))
+    return;
   i = hashKey (sname);
 
   bp = stab[i];
@@ -234,10 +258,13 @@ findSym (bucket ** stab, void *sym, const char *sname)
 {
   bucket *bp;
 
+  if (!(sname = tabName (sname)))
+    return NULL;
+
   bp = stab[hashKey (sname)];
   while (bp)
     {
-      if (bp->sym == sym || strcmp (bp->name, sname) == 0)
+      if (bp->sym == sym || bp->name == sname)
         break;
       bp = bp->next;
     }
@@ -252,11 +279,12 @@ void *
 findSymWithLevel (bucket ** stab, symbol * sym)
 {
   bucket *bp;
+  const char *name;
 
-  if (!sym)
-    return sym;
+  if (!sym || !(name = symTabName (sym->name)))
+    return NULL;
 
-  bp = stab[hashKey (sym->name)];
+  bp = stab[hashKey (name)];
 
   /**
    **  do the search from the head of the list since the
@@ -268,7 +296,7 @@ findSymWithLevel (bucket ** stab, symbol * sym)
    **/
   while (bp)
     {
-      if (strcmp (bp->name, sym->name) == 0 && bp->level <= sym->level)
+      if (bp->name == name && bp->level <= sym->level)
         {
           /* if this is parameter then nothing else need to be checked */
           if (((symbol *) (bp->sym))->_isparm)
@@ -300,14 +328,15 @@ void *
 findSymWithBlock (bucket ** stab, symbol * sym, int block, int level)
 {
   bucket *bp;
+  const char *name;
 
-  if (!sym)
-    return sym;
+  if (!sym || !(name = symTabName (sym->name)))
+    return NULL;
 
-  bp = stab[hashKey (sym->name)];
+  bp = stab[hashKey (name)];
   while (bp)
     {
-      if (strcmp (bp->name, sym->name) == 0 && (bp->block == block || (bp->block < block && bp->level < level)))
+      if (bp->name == name && (bp->block == block || (bp->block < block && bp->level < level)))
         break;
       bp = bp->next;
     }
@@ -322,10 +351,12 @@ symbol *
 newSymbol (const char *name, int scope)
 {
   symbol *sym;
+  size_t len = strlen (name);
 
-  sym = Safe_alloc (sizeof (symbol));
+  sym = Global_alloc (sizeof (symbol));
 
-  strncpyz (sym->name, name, sizeof (sym->name));       /* copy the name */
+  sym->name = internStrn (name, len > SDCC_SYMNAME_MAX ? SDCC_SYMNAME_MAX : len);
+  sym->rname = internStr ("");
   sym->level = scope;           /* set the level */
   sym->block = currBlockno;
   sym->seqPoint = seqPointNo;
@@ -361,9 +392,9 @@ newStruct (const char *tag)
 {
   structdef *s;
 
-  s = Safe_alloc (sizeof (structdef));
+  s = Global_alloc (sizeof (structdef));
 
-  strncpyz (s->tag, tag, sizeof (s->tag));      /* copy the tag */
+  s->tag = internStr (tag);
   return s;
 }
 
@@ -1324,6 +1355,7 @@ addSymChain (symbol ** symHead)
     {
       changePointer (sym->type);
       checkTypeSanity (sym->etype, sym->name);
+      ltoDeclare (sym);
 
       if (IS_NORETURN (sym->etype))
         {
@@ -1438,6 +1470,10 @@ addSymChain (symbol ** symHead)
               SPEC_EXTR (sym->etype) = SPEC_EXTR (csym->etype);
             }
 
+          /* a later module of a --lto source declares a defined function */
+          if (ltoKeepDefinition (csym))
+            continue;
+
           /* delete current entry */
           deleteSym (SymbolTab, csym, csym->name);
           deleteFromSeg (csym);
@@ -1549,7 +1585,7 @@ compStructSize (int su, structdef * sdef)
   while (loop)
     {
       /* create the internal name for this variable */
-      SNPRINTF (loop->rname, sizeof (loop->rname), "_%s", loop->name);
+      loop->rname = internPrintf ("_%s", loop->name);
       if (su == UNION)
         {
           sum = 0;
@@ -2037,7 +2073,7 @@ cleanUpBlock (bucket ** table, int block)
   bucket *chain;
 
   /* go thru the entire  table  */
-  for (i = 0; i < 256; i++)
+  for (i = 0; i < HASHTAB_SIZE; i++)
     {
       for (chain = table[i]; chain; chain = chain->next)
         {
@@ -2060,7 +2096,7 @@ cleanUpLevel (bucket ** table, int level)
   bucket *chain;
 
   /* go thru the entire  table  */
-  for (i = 0; i < 256; i++)
+  for (i = 0; i < HASHTAB_SIZE; i++)
     {
       for (chain = table[i]; chain; chain = chain->next)
         {
@@ -2634,7 +2670,7 @@ compareType (sym_link *dest, sym_link *src)
     }
   else if (IS_STRUCT (dest))
     {
-      if (SPEC_STRUCT (dest) != SPEC_STRUCT (src))
+      if (SPEC_STRUCT (dest) != SPEC_STRUCT (src) && !ltoSameStruct (SPEC_STRUCT (dest), SPEC_STRUCT (src)))
         return 0;
       else
         return 1;
@@ -2763,7 +2799,7 @@ compareTypeExact (sym_link * dest, sym_link * src, int level)
 
   if (IS_STRUCT (dest))
     {
-      if (SPEC_STRUCT (dest) != SPEC_STRUCT (src))
+      if (SPEC_STRUCT (dest) != SPEC_STRUCT (src) && !ltoSameStruct (SPEC_STRUCT (dest), SPEC_STRUCT (src)))
         return 0;
     }
 
@@ -3025,7 +3061,7 @@ checkFunction (symbol * sym, symbol * csym)
           acargs->sym->type = copyLinkChain (acargs->type);
           acargs->sym->etype = getSpec (acargs->sym->type);
           acargs->sym->_isparm = 1;
-          strncpyz (acargs->sym->rname, acargs->name, sizeof (acargs->sym->rname));
+          acargs->sym->rname = internStr (acargs->name);
         }
       else if (strcmp (acargs->sym->name, acargs->sym->rname) == 0)
         {
@@ -3187,7 +3223,7 @@ cdbStructBlock (int block)
   bucket *chain;
 
   /* go thru the entire  table  */
-  for (i = 0; i < 256; i++)
+  for (i = 0; i < HASHTAB_SIZE; i++)
     {
       for (chain = table[i]; chain; chain = chain->next)
         {
@@ -3331,13 +3367,13 @@ processFuncArgs (symbol * func)
           if (!defaultOClass (val->sym))
             SPEC_OCLS (val->sym->etype) = port->mem.default_local_map;
           SPEC_OCLS (val->etype) = SPEC_OCLS (val->sym->etype);
-          strncpyz (val->sym->rname, val->name, sizeof (val->sym->rname));
+          val->sym->rname = internStr (val->name);
           addSymChain (&val->sym);
         }
       else                      /* symbol name given create synth name */
         {
           SNPRINTF (val->name, sizeof (val->name), "_%s_PARM_%d", func->name, pNum++);
-          strncpyz (val->sym->rname, val->name, sizeof (val->sym->rname));
+          val->sym->rname = internStr (val->name);
           val->sym->_isparm = 1;
           if (!defaultOClass (val->sym))
             SPEC_OCLS (val->sym->etype) = port->mem.default_local_map;
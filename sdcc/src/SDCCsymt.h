@@ -75,13 +75,14 @@ enum
 #define GPTYPE_CODE     (port->gp_tags.tag_code)
 #endif
 
-#define HASHTAB_SIZE 256
+#define HASHTAB_BITS 12
+#define HASHTAB_SIZE (1 << HASHTAB_BITS)
 
 /* hash table bucket */
 typedef struct bucket
 {
   void *sym;                    /* pointer to the object      */
-  char name[SDCC_NAME_MAX + 1]; /* name of this symbol        */
+  const char *name;             /* interned name of this symbol */
   int level;                    /* nest level for this symbol */
   int block;                    /* belongs to which block     */
   struct bucket *prev;          /* ptr 2 previous bucket      */
@@ -91,7 +92,7 @@ bucket;
 
 typedef struct structdef
 {
-  char tag[SDCC_NAME_MAX + 1];  /* tag part of structure      */
+  const char *tag;              /* interned tag of structure  */
   unsigned char level;          /* Nesting level              */
   int block;                    /* belongs to which block     */
   struct symbol *fields;        /* pointer to fields          */
@@ -289,8 +290,8 @@ sym_link;
 
 typedef struct symbol
 {
-  char name[SDCC_SYMNAME_MAX + 1];  /* Input Variable Name     */
-  char rname[SDCC_NAME_MAX + 1];    /* internal name           */
+  char *name;                       /* Input Variable Name (interned, read-only) */
+  char *rname;                      /* internal name (interned, read-only) */
 
   short level;                      /* declaration lev,fld offset */
   short block;                      /* sequential block # of definition */
@@ -353,6 +354,8 @@ typedef struct symbol
   int xstack;                       /* offset on xternal stack */
   short nRegs;                      /* number of registers required */
   short regType;                    /* type of register required    */
+  short ltoModule;                  /* --lto: module of a static symbol in a combined source */
+  struct symbol *ltoBind;           /* --lto: file scope symbol a reference in an inline function binds to */
 
   struct reg_info *regs[8];         /* can have at the most 8 registers */
   struct asmop *aop;                /* asmoperand for this symbol */
@@ -382,6 +385,7 @@ typedef struct symbol
   struct bitVect *defs;             /* bit vector for definitions */
   struct bitVect *uses;             /* bit vector for uses        */
   struct bitVect *regsUsed;         /* for functions registers used */
+  struct bitVect *regsClobbered;    /* for functions registers changed, if known */
   int liveFrom;                     /* live from iCode sequence number */
   int liveTo;                       /* live to sequence number */
   int used;                         /* no. of times this was used */
@@ -703,7 +707,8 @@ void pointerTypes (sym_link *, sym_link *);
 void cdbStructBlock (int);
 void initHashT ();
 bucket *newBucket ();
-void addSym (bucket **, void *, char *, int, int, int checkType);
+int hashKey (const char *);
+void addSym (bucket **, void *, const char *, int, int, int checkType);
 void deleteSym (bucket **, void *, const char *);
 void *findSym (bucket **, void *, const char *);
 void *findSymWithLevel (bucket **, struct symbol *);
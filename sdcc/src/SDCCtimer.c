@@ -0,0 +1,487 @@
+/*-------------------------------------------------------------------------
+  SDCCtimer.c - compile time profiling of the compiler passes
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#include "common.h"
+#include <time.h>
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+
+#define TIMER_MAX_DEPTH 32
+#define TIMER_MAX_FUNCS 20     /* functions listed by timerReport () */
+
+/* accumulated data of one pass */
+typedef struct timerPass
+{
+  const char *name;
+  long calls;                   /* number of times the pass was run */
+  double time;                  /* wall time including nested passes */
+  double self;                  /* wall time excluding nested passes */
+  size_t alloc;                 /* bytes allocated */
+  long count;                   /* iterations, see timerAddCount () */
+}
+timerPass;
+
+/* one run of a pass, kept for --time-trace and the function table */
+typedef struct timerEvent
+{
+  int pass;                     /* index into passes, -1 for a function */
+  int func;                     /* index into funcs, -1 outside functions */
+  int depth;                    /* nesting depth */
+  double start;
+  double time;
+  double self;
+  size_t alloc;
+  size_t selfAlloc;
+}
+timerEvent;
+
+/* accumulated data of one function */
+typedef struct timerFunc
+{
+  const char *name;
+  double time;
+  size_t alloc;
+}
+timerFunc;
+
+/* a count of something other than pass iterations, see timerCount () */
+typedef struct timerCounter
+{
+  const char *name;
+  long long value;
+}
+timerCounter;
+
+/* a running timer */
+typedef struct timerFrame
+{
+  int pass;
+  double start;
+  double nested;                /* time spent in nested passes */
+  size_t alloc;
+  size_t nestedAlloc;           /* bytes allocated by nested passes */
+}
+timerFrame;
+
+static timerPass *passes;
+static int nPasses, allocPasses;
+
+static timerEvent *events;
+static int nEvents, allocEvents;
+
+static timerFunc *funcs;
+static int nFuncs, allocFuncs;
+
+static timerCounter *counters;
+static int nCounters, allocCounters;
+
+static timerFrame stack[TIMER_MAX_DEPTH];
+static int depth;
+
+static int currFuncIndex = -1;
+static double funcStart;
+static size_t funcAlloc;
+
+static double startTime = -1;
+
+/*-----------------------------------------------------------------*/
+/* timerEnabled - are compile times collected at all               */
+/*-----------------------------------------------------------------*/
+static bool
+timerEnabled (void)
+{
+  return options.time_report || options.time_trace;
+}
+
+/*-----------------------------------------------------------------*/
+/* timerNow - wall clock time in seconds                           */
+/*-----------------------------------------------------------------*/
+static double
+timerNow (void)
+{
+#ifdef _WIN32
+  /* clock () measures wall time on Windows */
+  return (double) clock () / CLOCKS_PER_SEC;
+#else
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+}
+
+/*-----------------------------------------------------------------*/
+/* timerStart - remembers when the compilation started             */
+/*-----------------------------------------------------------------*/
+static void
+timerStart (void)
+{
+  if (startTime < 0)
+    startTime = timerNow ();
+}
+
+/*-----------------------------------------------------------------*/
+/* passIndex - finds or creates the entry for a pass               */
+/*-----------------------------------------------------------------*/
+static int
+passIndex (const char *name)
+{
+  int i;
+
+  for (i = 0; i < nPasses; i++)
+    if (passes[i].name == name || !strcmp (passes[i].name, name))
+      return i;
+
+  if (nPasses == allocPasses)
+    {
+      allocPasses = allocPasses ? allocPasses * 2 : 32;
+      passes = Safe_realloc (passes, allocPasses * sizeof (timerPass));
+    }
+  memset (&passes[nPasses], 0, sizeof (timerPass));
+  passes[nPasses].name = name;
+  return nPasses++;
+}
+
+/*-----------------------------------------------------------------*/
+/* newEvent - appends an event to the trace                        */
+/*-----------------------------------------------------------------*/
+static timerEvent *
+newEvent (void)
+{
+  if (nEvents == allocEvents)
+    {
+      allocEvents = allocEvents ? allocEvents * 2 : 256;
+      events = Safe_realloc (events, allocEvents * sizeof (timerEvent));
+    }
+  return &events[nEvents++];
+}
+
+/*-----------------------------------------------------------------*/
+/* timerBeginFunction - starts timing a function                   */
+/*-----------------------------------------------------------------*/
+void
+timerBeginFunction (const char *name)
+{
+  if (!timerEnabled ())
+    return;
+
+  timerStart ();
+
+  if (nFuncs == allocFuncs)
+    {
+      allocFuncs = allocFuncs ? allocFuncs * 2 : 64;
+      funcs = Safe_realloc (funcs, allocFuncs * sizeof (timerFunc));
+    }
+  funcs[nFuncs].name = Safe_strdup (name);
+  funcs[nFuncs].time = 0;
+  funcs[nFuncs].alloc = 0;
+  currFuncIndex = nFuncs++;
+
+  funcStart = timerNow ();
+  funcAlloc = Safe_allocated;
+}
+
+/*-----------------------------------------------------------------*/
+/* timerEndFunction - stops timing a function                      */
+/*-----------------------------------------------------------------*/
+void
+timerEndFunction (void)
+{
+  timerEvent *ev;
+
+  if (!timerEnabled () || currFuncIndex < 0)
+    return;
+
+  funcs[currFuncIndex].time = timerNow () - funcStart;
+  funcs[currFuncIndex].alloc = Safe_allocated - funcAlloc;
+
+  ev = newEvent ();
+  ev->pass = -1;
+  ev->func = currFuncIndex;
+  ev->depth = 0;
+  ev->start = funcStart;
+  ev->time = ev->self = funcs[currFuncIndex].time;
+  ev->alloc = ev->selfAlloc = funcs[currFuncIndex].alloc;
+
+  currFuncIndex = -1;
+}
+
+/*-----------------------------------------------------------------*/
+/* timerBegin - starts timing a pass                               */
+/*-----------------------------------------------------------------*/
+void
+timerBegin (const char *pass)
+{
+  timerFrame *frame;
+
+  if (!timerEnabled ())
+    return;
+
+  timerStart ();
+
+  wassertl (depth < TIMER_MAX_DEPTH, "timers nested too deep");
+
+  frame = &stack[depth++];
+  frame->pass = passIndex (pass);
+  frame->nested = 0;
+  frame->alloc = Safe_allocated;
+  frame->nestedAlloc = 0;
+  frame->start = timerNow ();
+}
+
+/*-----------------------------------------------------------------*/
+/* timerEnd - stops timing a pass                                  */
+/*-----------------------------------------------------------------*/
+void
+timerEnd (const char *pass)
+{
+  timerFrame *frame;
+  timerPass *tp;
+  timerEvent *ev;
+  double time;
+
+  if (!timerEnabled ())
+    return;
+
+  wassertl (depth > 0, "timerEnd () without timerBegin ()");
+  frame = &stack[--depth];
+  tp = &passes[frame->pass];
+  wassertl (tp->name == pass || !strcmp (tp->name, pass), "mismatched timerEnd ()");
+
+  time = timerNow () - frame->start;
+  if (depth > 0)
+    {
+      stack[depth - 1].nested += time;
+      stack[depth - 1].nestedAlloc += Safe_allocated - frame->alloc;
+    }
+
+  tp->calls++;
+  tp->time += time;
+  tp->self += time - frame->nested;
+  tp->alloc += Safe_allocated - frame->alloc;
+
+  ev = newEvent ();
+  ev->pass = frame->pass;
+  ev->func = currFuncIndex;
+  ev->depth = depth + (currFuncIndex >= 0);
+  ev->start = frame->start;
+  ev->time = time;
+  ev->self = time - frame->nested;
+  ev->alloc = Safe_allocated - frame->alloc;
+  ev->selfAlloc = ev->alloc - frame->nestedAlloc;
+}
+
+/*-----------------------------------------------------------------*/
+/* timerAddCount - counts iterations of a pass                     */
+/*-----------------------------------------------------------------*/
+void
+timerAddCount (const char *pass, long count)
+{
+  if (!timerEnabled ())
+    return;
+
+  passes[passIndex (pass)].count += count;
+}
+
+/*-----------------------------------------------------------------*/
+/* timerCount - adds count to a counter                            */
+/*-----------------------------------------------------------------*/
+void
+timerCount (const char *counter, long count)
+{
+  int i;
+
+  if (!timerEnabled ())
+    return;
+
+  for (i = 0; i < nCounters; i++)
+    if (counters[i].name == counter || !strcmp (counters[i].name, counter))
+      break;
+
+  if (i == nCounters)
+    {
+      if (nCounters == allocCounters)
+        {
+          allocCounters = allocCounters ? allocCounters * 2 : 16;
+          counters = Safe_realloc (counters, allocCounters * sizeof (timerCounter));
+        }
+      counters[nCounters].name = counter;
+      counters[nCounters].value = 0;
+      nCounters++;
+    }
+  counters[i].value += count;
+}
+
+/*-----------------------------------------------------------------*/
+/* funcTimeCompare - sort functions by decreasing time             */
+/*-----------------------------------------------------------------*/
+static int
+funcTimeCompare (const void *a, const void *b)
+{
+  const timerFunc *fa = *(const timerFunc **) a;
+  const timerFunc *fb = *(const timerFunc **) b;
+
+  return fa->time < fb->time ? 1 : fa->time > fb->time ? -1 : 0;
+}
+
+/*-----------------------------------------------------------------*/
+/* slowestPass - the pass with the most self time in a function    */
+/*-----------------------------------------------------------------*/
+static const char *
+slowestPass (int func)
+{
+  double *self = Safe_alloc ((nPasses + 1) * sizeof (double));
+  int i, best = -1;
+
+  for (i = 0; i < nEvents; i++)
+    if (events[i].func == func && events[i].pass >= 0)
+      {
+        self[events[i].pass] += events[i].self;
+        if (best < 0 || self[events[i].pass] > self[best])
+          best = events[i].pass;
+      }
+  Safe_free (self);
+
+  return best < 0 ? "-" : passes[best].name;
+}
+
+/*-----------------------------------------------------------------*/
+/* timerReport - prints the summary table                          */
+/*-----------------------------------------------------------------*/
+void
+timerReport (FILE *of)
+{
+  double total;
+  timerFunc **sorted;
+  int i;
+
+  if (!timerEnabled () || startTime < 0)
+    return;
+
+  total = timerNow () - startTime;
+  if (total <= 0)
+    total = 1e-9;
+
+  fprintf (of, "Time report for %s: %.3f s total\n", fullSrcFileName ? fullSrcFileName : "stdin", total);
+  fprintf (of, "  %-28s %7s %10s %10s %6s %10s %10s\n", "pass", "calls", "time (s)", "self (s)", "self%", "alloc (kB)", "iterations");
+  for (i = 0; i < nPasses; i++)
+    {
+      fprintf (of, "  %-28s %7ld %10.3f %10.3f %6.1f %10lu",
+               passes[i].name, passes[i].calls, passes[i].time, passes[i].self, 100.0 * passes[i].self / total,
+               (unsigned long) (passes[i].alloc / 1024));
+      if (passes[i].count)
+        fprintf (of, " %10ld\n", passes[i].count);
+      else
+        fprintf (of, " %10s\n", "-");
+    }
+
+  if (nCounters)
+    fprintf (of, "  %-28s %7s %10s\n", "counter", "", "count");
+  for (i = 0; i < nCounters; i++)
+    fprintf (of, "  %-28s %7s %10lld\n", counters[i].name, "", counters[i].value);
+
+  if (!nFuncs)
+    return;
+
+  sorted = Safe_alloc (nFuncs * sizeof (timerFunc *));
+  for (i = 0; i < nFuncs; i++)
+    sorted[i] = &funcs[i];
+  qsort (sorted, nFuncs, sizeof (timerFunc *), funcTimeCompare);
+
+  fprintf (of, "  %-28s %7s %10s %10s %6s %10s  %s\n", "function", "", "time (s)", "", "%", "alloc (kB)", "slowest pass");
+  for (i = 0; i < nFuncs && i < TIMER_MAX_FUNCS; i++)
+    fprintf (of, "  %-28s %7s %10.3f %10s %6.1f %10lu  %s\n",
+             sorted[i]->name, "", sorted[i]->time, "", 100.0 * sorted[i]->time / total,
+             (unsigned long) (sorted[i]->alloc / 1024), slowestPass (sorted[i] - funcs));
+  if (nFuncs > TIMER_MAX_FUNCS)
+    fprintf (of, "  (%d more functions)\n", nFuncs - TIMER_MAX_FUNCS);
+
+  Safe_free (sorted);
+}
+
+/*-----------------------------------------------------------------*/
+/* printJsonString - prints a string as a JSON string literal      */
+/*-----------------------------------------------------------------*/
+static void
+printJsonString (FILE *of, const char *s)
+{
+  fputc ('"', of);
+  for (; *s; s++)
+    {
+      if (*s == '"' || *s == '\\')
+        fprintf (of, "\\%c", *s);
+      else if ((unsigned char) *s < ' ')
+        fprintf (of, "\\u%04x", (unsigned char) *s);
+      else
+        fputc (*s, of);
+    }
+  fputc ('"', of);
+}
+
+/*-----------------------------------------------------------------*/
+/* timerWriteTrace - writes the events in Chrome trace format      */
+/*-----------------------------------------------------------------*/
+void
+timerWriteTrace (const char *fileName)
+{
+  FILE *of;
+  int i;
+
+  if (!fileName || startTime < 0)
+    return;
+
+  if (!(of = fopen (fileName, "w")))
+    {
+      werror (E_FILE_OPEN_ERR, fileName);
+      return;
+    }
+
+  fprintf (of, "{\"traceEvents\":[\n");
+
+  /* the counters at the end of the compilation */
+  for (i = 0; i < nCounters; i++)
+    {
+      fprintf (of, "{\"name\":");
+      printJsonString (of, counters[i].name);
+      fprintf (of, ",\"cat\":\"counter\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":%.0f,\"args\":{\"value\":%lld}}%s\n",
+               (timerNow () - startTime) * 1e6, counters[i].value, nEvents ? "," : "");
+    }
+
+  for (i = 0; i < nEvents; i++)
+    {
+      const timerEvent *ev = &events[i];
+
+      fprintf (of, "{\"name\":");
+      printJsonString (of, ev->pass < 0 ? funcs[ev->func].name : passes[ev->pass].name);
+      fprintf (of, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.0f,\"dur\":%.0f,\"args\":{",
+               ev->pass < 0 ? "function" : "pass", (ev->start - startTime) * 1e6, ev->time * 1e6);
+      if (ev->func >= 0)
+        {
+          fprintf (of, "\"function\":");
+          printJsonString (of, funcs[ev->func].name);
+          fprintf (of, ",");
+        }
+      if (ev->pass >= 0)
+        fprintf (of, "\"self\":%.0f,\"selfAlloc\":%lu,", ev->self * 1e6, (unsigned long) ev->selfAlloc);
+      fprintf (of, "\"alloc\":%lu}}%s\n", (unsigned long) ev->alloc, i + 1 < nEvents ? "," : "");
+    }
+  fprintf (of, "],\"displayTimeUnit\":\"ms\"}\n");
+
+  fclose (of);
+}
@@ -0,0 +1,48 @@
+/*-------------------------------------------------------------------------
+  SDCCtimer.h - compile time profiling of the compiler passes
+
+  This program is free software; you can redistribute it and/or modify it
+  under the terms of the GNU General Public License as published by the
+  Free Software Foundation; either version 2, or (at your option) any
+  later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#ifndef SDCCTIMER_H
+#define SDCCTIMER_H 1
+
+/** Starts / stops collecting time for the function being compiled.
+ *  Passes timed in between are attributed to that function.
+ */
+void timerBeginFunction (const char *name);
+void timerEndFunction (void);
+
+/** Starts / stops timing a pass. Passes may nest; pass names must be
+ *  string literals or otherwise outlive the compilation.
+ */
+void timerBegin (const char *pass);
+void timerEnd (const char *pass);
+
+/** Adds count to the iteration counter of a pass. */
+void timerAddCount (const char *pass, long count);
+
+/** Adds count to a named counter of work done, e.g. peephole rule
+ *  matches tried. Counter names must outlive the compilation as well.
+ */
+void timerCount (const char *counter, long count);
+
+/** Prints the summary table of --time-report. */
+void timerReport (FILE *of);
+
+/** Writes all timed passes as Chrome trace events (--time-trace). */
+void timerWriteTrace (const char *fileName);
+
+#endif
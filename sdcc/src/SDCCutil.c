@@ -1189,3 +1189,195 @@ char *formatInlineAsm (char *asmStr)
         return asmStr;
     }
 }
+
+/*-----------------------------------------------------------------*/
+/* Arena allocation                                                */
+/*-----------------------------------------------------------------*/
+static allocArena funcArena = { "function" };
+static allocArena globalArena = { "global" };
+static bool funcArenaActive;
+
+void
+beginFuncAlloc (void)
+{
+  funcArenaActive = TRUE;
+}
+
+void
+endFuncAlloc (void)
+{
+  if (funcArenaActive)
+    freeArena (&funcArena);
+  funcArenaActive = FALSE;
+}
+
+bool
+inFuncAlloc (void)
+{
+  return funcArenaActive;
+}
+
+void *
+Func_alloc (size_t size)
+{
+  return funcArenaActive ? arenaAlloc (&funcArena, size) : Safe_alloc (size);
+}
+
+char *
+Func_strdup (const char *sz)
+{
+  return funcArenaActive ? arenaStrdup (&funcArena, sz) : Safe_strdup (sz);
+}
+
+void *
+Global_alloc (size_t size)
+{
+  return arenaAlloc (&globalArena, size);
+}
+
+static void
+printArenaStats (FILE *fp, const allocArena *parena)
+{
+  fprintf (fp, "%-10s %10lu %12lu %12lu %12lu %8d\n",
+           parena->name,
+           (unsigned long) parena->totalNum, (unsigned long) parena->totalUsed,
+           (unsigned long) parena->reserved, (unsigned long) parena->peak,
+           parena->frees);
+}
+
+void
+printMemStats (FILE *fp)
+{
+  fprintf (fp, "%-10s %10s %12s %12s %12s %8s\n", "arena", "allocs", "bytes", "reserved", "peak", "frees");
+  printArenaStats (fp, &globalArena);
+  printArenaStats (fp, &funcArena);
+}
+
+/*-----------------------------------------------------------------*/
+/* String interning                                                */
+/*-----------------------------------------------------------------*/
+static struct
+{
+  char **strs;                  /* open addressing, linear probing */
+  unsigned long *hashes;
+  size_t size;                  /* always a power of two */
+  size_t count;
+} internTab;
+
+static unsigned long
+internHash (const char *sz, size_t len)
+{
+  unsigned long hash = 2166136261UL;    /* FNV-1a */
+
+  while (len--)
+    hash = ((hash ^ (unsigned char) *sz++) * 16777619UL) & 0xffffffffUL;
+  return hash;
+}
+
+static size_t
+internSlot (const char *sz, size_t len, unsigned long hash)
+{
+  size_t i = hash & (internTab.size - 1);
+
+  while (internTab.strs[i])
+    {
+      if (internTab.hashes[i] == hash && !strncmp (internTab.strs[i], sz, len) && !internTab.strs[i][len])
+        break;
+      i = (i + 1) & (internTab.size - 1);
+    }
+  return i;
+}
+
+static void
+internGrow (void)
+{
+  char **strs = internTab.strs;
+  unsigned long *hashes = internTab.hashes;
+  size_t size = internTab.size;
+  size_t i;
+
+  internTab.size = size ? size * 2 : 4096;
+  internTab.strs = Safe_calloc (internTab.size, sizeof (char *));
+  internTab.hashes = Safe_calloc (internTab.size, sizeof (unsigned long));
+
+  for (i = 0; i < size; i++)
+    if (strs[i])
+      {
+        size_t j = hashes[i] & (internTab.size - 1);
+
+        while (internTab.strs[j])
+          j = (j + 1) & (internTab.size - 1);
+        internTab.strs[j] = strs[i];
+        internTab.hashes[j] = hashes[i];
+      }
+
+  Safe_free (strs);
+  Safe_free (hashes);
+}
+
+char *
+internFind (const char *sz, size_t len)
+{
+  size_t i;
+
+  if (!internTab.size)
+    return NULL;
+
+  i = internSlot (sz, len, internHash (sz, len));
+  return internTab.strs[i];
+}
+
+char *
+internStrn (const char *sz, size_t len)
+{
+  unsigned long hash = internHash (sz, len);
+  size_t i;
+
+  /* keep the load factor below one half */
+  if (2 * (internTab.count + 1) > internTab.size)
+    internGrow ();
+
+  i = internSlot (sz, len, hash);
+  if (!internTab.strs[i])
+    {
+      /* the hash is kept in front of the string, see internHashOf () */
+      unsigned long *ph = Global_alloc (sizeof (unsigned long) + len + 1);
+      char *p = (char *) (ph + 1);
+
+      *ph = hash;
+      memcpy (p, sz, len);
+      internTab.strs[i] = p;
+      internTab.hashes[i] = hash;
+      internTab.count++;
+    }
+  return internTab.strs[i];
+}
+
+unsigned long
+internHashOf (const char *interned)
+{
+  return ((const unsigned long *) interned)[-1];
+}
+
+char *
+internStr (const char *sz)
+{
+  return internStrn (sz, strlen (sz));
+}
+
+char *
+internPrintf (const char *format, ...)
+{
+  struct dbuf_s dbuf;
+  va_list ap;
+  char *p;
+
+  dbuf_init (&dbuf, 128);
+  va_start (ap, format);
+  dbuf_vprintf (&dbuf, format, ap);
+  va_end (ap);
+  p = internStrn (dbuf_get_buf (&dbuf), dbuf_get_length (&dbuf));
+  dbuf_destroy (&dbuf);
+
+  return p;
+}
@@ -177,4 +177,40 @@ void getPrefixSuffix(const char *);
 char *setPrefixSuffix(const char *);
 
 char *formatInlineAsm (char *);
+
+/** Per function arena for the iCodes, operands, basic blocks and code
+ *  lines of the function being compiled. While no function arena is
+ *  active Func_alloc falls back to Safe_alloc.
+ */
+void beginFuncAlloc (void);
+void endFuncAlloc (void);
+void *Func_alloc (size_t size);
+char *Func_strdup (const char *sz);
+bool inFuncAlloc (void);
+
+/** Arena for AST nodes and symbol table data, never released.
+ */
+void *Global_alloc (size_t size);
+
+/** Prints the arena statistics (--mem-stats).
+ */
+void printMemStats (FILE *fp);
+
+/** String interning: equal strings are returned as the same pointer, so
+ *  interned names can be compared with ==. Interned strings live in the
+ *  global arena and must not be modified.
+ */
+char *internStr (const char *sz);
+char *internStrn (const char *sz, size_t len);
+char *internPrintf (const char *format, ...);
+
+/** Returns the interned copy of the first len characters of sz, or NULL
+ *  if that string has never been interned.
+ */
+char *internFind (const char *sz, size_t len);
+
+/** Returns the hash of an interned string's contents. Unlike its address
+ *  it does not change from one run to the next.
+ */
+unsigned long internHashOf (const char *interned);
 #endif
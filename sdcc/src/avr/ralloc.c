@@ -2293,7 +2293,9 @@ avr_assignRegisters (ebbIndex * ebbi)
 	ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbs, count));
 
 
+	timerBegin ("genCode");
 	genAVRCode (ic);
+	timerEnd ("genCode");
 	/*     for (; ic ; ic = ic->next) */
 	/*          piCode(ic,stdout); */
 	/* free up any _G.stackSpil locations allocated */
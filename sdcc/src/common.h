@@ -61,6 +61,10 @@ extern "C" {
 #include "SDCCutil.h"
 #include "SDCCasm.h"
 #include "SDCCsystem.h"
+#include "SDCCtimer.h"
+#include "SDCCprofile.h"
+#include "SDCCcache.h"
+#include "SDCClto.h"
 
 #include "port.h"
 
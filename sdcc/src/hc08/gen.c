@@ -106,13 +106,16 @@ static void updateiTempRegisterUse (operand * op);
 #define AOP_OP(aop) aop->op
 
 static bool regalloc_dry_run;
-static unsigned char regalloc_dry_run_cost;
+static unsigned int regalloc_dry_run_cost;
+static unsigned int regalloc_dry_run_cycles;    /* Cycles of code not emitted during the dry run. */
 
 static void
 emitBranch (char *branchop, symbol * tlbl)
 {
   if (!regalloc_dry_run)
     emitcode (branchop, "%05d$", labelKey2num (tlbl->key));
+  else
+    regalloc_dry_run_cycles += (!strcmp(branchop, "brclr") || !strcmp(branchop, "brset") ? 5 : 3);
   regalloc_dry_run_cost += (!strcmp(branchop, "jmp") || !strcmp(branchop, "brclr") || !strcmp(branchop, "brset") ? 3 : 2);
 }
 
@@ -10415,6 +10418,116 @@ updateiTempRegisterUse (operand * op)
     }
 }
 
+/* Cycles of the instructions that take the same time in all addressing modes. */
+static const struct
+{
+  const char *name;
+  unsigned char cycles;
+} fixedCycles[] =
+{
+  {"tax", 1}, {"txa", 1}, {"tpa", 1}, {"clc", 1}, {"sec", 1}, {"nop", 1},
+  {"tap", 2}, {"daa", 2}, {"tsx", 2}, {"txs", 2}, {"ais", 2}, {"aix", 2},
+  {"psha", 2}, {"pshx", 2}, {"pshh", 2}, {"pula", 2}, {"pulx", 2}, {"pulh", 2},
+  {"nsa", 3}, {"dbnza", 3}, {"dbnzx", 3}, {"cbeqa", 4}, {"cbeqx", 4},
+  {"rts", 4}, {"bsr", 4}, {"bset", 4}, {"bclr", 4}, {"mul", 5}, {"mov", 5},
+  {"brset", 5}, {"brclr", 5}, {"cbeq", 5}, {"dbnz", 5}, {"rti", 7}, {"div", 7},
+  {"jmp", 3}, {"jsr", 5},
+};
+
+/* Instructions that read or write memory and take an accumulator, index or
+   immediate operand. */
+static const char *const aluNames[] =
+{
+  "lda", "sta", "ldx", "stx", "add", "adc", "sub", "sbc", "and", "ora", "eor",
+  "cmp", "cpx", "bit",
+};
+
+/* Read-modify-write instructions. Followed by a, x or h they modify a register. */
+static const char *const rmwNames[] =
+{
+  "inc", "dec", "clr", "neg", "com", "lsl", "asl", "rol", "asr", "lsr", "ror", "tst",
+};
+
+/*-----------------------------------------------------------------*/
+/* lineCycles - estimates the cycles taken by an asm line          */
+/*-----------------------------------------------------------------*/
+static unsigned int
+lineCycles (const char *line)
+{
+  char name[8];
+  size_t len, i;
+  enum { INH, IMM, DIR, EXT, IX, IX1, SP } mode;
+
+  line += strspn (line, " \t");
+  len = strspn (line, "abcdefghijklmnopqrstuvwxyz");
+  if (!len || len >= sizeof (name))
+    return (0);
+  memcpy (name, line, len);
+  name[len] = '\0';
+  line += len;
+  line += strspn (line, " \t");
+
+  for (i = 0; i < sizeof (fixedCycles) / sizeof (fixedCycles[0]); i++)
+    if (!strcmp (name, fixedCycles[i].name))
+      return (fixedCycles[i].cycles);
+
+  if (!*line)
+    mode = INH;
+  else if (*line == '#')
+    mode = IMM;
+  else if (strstr (line, ",s"))
+    mode = SP;
+  else if (*line == ',')
+    mode = IX;
+  else if (strstr (line, ",x"))
+    mode = IX1;
+  else if (*line == '*')
+    mode = DIR;
+  else
+    mode = EXT;
+
+  if (name[0] == 'b' && strcmp (name, "bit"))
+    return (3);
+
+  if (!strcmp (name, "ldhx") || !strcmp (name, "sthx") || !strcmp (name, "cphx"))
+    return (mode == IMM ? 3 : mode == DIR ? 4 : mode == SP && name[0] == 'c' ? 6 : 5);
+
+  for (i = 0; i < sizeof (aluNames) / sizeof (aluNames[0]); i++)
+    if (!strcmp (name, aluNames[i]))
+      switch (mode)
+        {
+        case IMM:
+        case IX:
+          return (2);
+        case DIR:
+        case IX1:
+          return (3);
+        case SP:
+        case EXT:
+        default:
+          return (4);
+        }
+
+  for (i = 0; i < sizeof (rmwNames) / sizeof (rmwNames[0]); i++)
+    if (!strncmp (name, rmwNames[i], 3))
+      {
+        bool tst = !strcmp (rmwNames[i], "tst");
+        if (len == 4)           /* inca, clrx, ... */
+          return (1);
+        switch (mode)
+          {
+          case IX:
+            return (3 - tst);
+          case SP:
+            return (5 - tst);
+          default:
+            return (4 - tst);
+          }
+      }
+
+  return (3);                   // Fallback
+}
+
 /*---------------------------------------------------------------------------------------*/
 /* genhc08iode - generate code for HC08 based controllers for a single iCode instruction */
 /*---------------------------------------------------------------------------------------*/
@@ -10719,20 +10832,35 @@ init_aop_pass(void)
   hc08_aop_pass[7]->aopu.aop_dir = "___SDCC_hc08_ret7";
 }
 
-unsigned char
+/* The cost of the code for ic: its size in bytes. With --opt-code-speed,
+   the cycles, weighted by the execution count of ic, are added in units
+   of the time taken to fetch two bytes. */
+float
 dryhc08iCode (iCode *ic)
 {
+  unsigned int cycles = 0;
+  const lineNode *line;
+
   regalloc_dry_run = TRUE;
   regalloc_dry_run_cost = 0;
+  regalloc_dry_run_cycles = 0;
 
   init_aop_pass();
   
   genhc08iCode (ic);
 
+  if (optimize.codeSpeed && !optimize.codeSize)
+    for (line = genLine.lineHead; line; line = line->next)
+      if (!line->isComment && !line->isLabel && !line->isDebug)
+        cycles += lineCycles (line->line);
+
   destroy_line_list ();
   /*freeTrace (&_G.trace.aops);*/
 
-  return (regalloc_dry_run_cost);
+  if (!optimize.codeSpeed || optimize.codeSize)
+    return (regalloc_dry_run_cost);
+
+  return (regalloc_dry_run_cost + (cycles + regalloc_dry_run_cycles) * ic->count / 2);
 }
 
 /*-----------------------------------------------------------------*/
@@ -10811,6 +10939,7 @@ genhc08Code (iCode *lic)
           dbuf_free (iLine);
         }
 
+      emitProfileProbe (ic);
       regalloc_dry_run_cost = 0;
       genhc08iCode(ic);
       /*if (options.verboseAsm)
@@ -2270,7 +2270,9 @@ hc08_oldralloc (ebbIndex * ebbi)
   /* now get back the chain */
   ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbs, count));
 
+  timerBegin ("genCode");
   genhc08Code (ic);
+  timerEnd ("genCode");
 
   /* free up any _G.stackSpil locations allocated */
   applyToSet (_G.stackSpil, deallocStackSpil);
@@ -2434,7 +2436,9 @@ hc08_ralloc (ebbIndex * ebbi)
   serialRegMark (ebbs, count);
 
   /* The new register allocator invokes its magic */
+  timerBegin ("ralloc2");
   ic = hc08_ralloc2_cc (ebbi);
+  timerEnd ("ralloc2");
 
   RegFix (ebbs, count);
 
@@ -2471,7 +2475,9 @@ hc08_ralloc (ebbIndex * ebbi)
   /* now get back the chain */
   ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbs, count));
 
+  timerBegin ("genCode");
   genhc08Code (ic);
+  timerEnd ("genCode");
 
   /* free up any _G.stackSpil locations allocated */
   applyToSet (_G.stackSpil, deallocStackSpil);
@@ -28,7 +28,7 @@ extern "C"
 {
   #include "ralloc.h"
   #include "gen.h"
-  unsigned char dryhc08iCode (iCode *ic);
+  float dryhc08iCode (iCode *ic);
   bool hc08_assignment_optimal;
 };
 
@@ -669,7 +669,10 @@ iCode *hc08_ralloc2_cc(ebbIndex *ebbi)
 
   guessCounts (ic, ebbi);
 
+  static allocs_budget budget("register allocation", 0.6, 40000);
+  budget.begin(tree_decomposition);
   hc08_assignment_optimal = !tree_dec_ralloc(tree_decomposition, control_flow_graph, conflict_graph);
+  budget.end();
 
   return(ic);
 }
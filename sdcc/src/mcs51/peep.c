@@ -693,7 +693,7 @@ removeDeadPopPush (const char *pReg, lineNode *currPl, lineNode *head)
       #define STR ";\tPeephole\tpush %s removed"
       int size = sizeof(STR) + 2;
 
-      pushPl->line = Safe_alloc (size);
+      pushPl->line = Func_alloc (size);
       SNPRINTF (pushPl->line, size, STR, pReg);
       pushPl->isComment = TRUE;
     }
@@ -977,7 +977,7 @@ popGetExternal (const char *str, int isReg)
       if (!sym)
         {
           sym = newSymbol (str, 0);
-          strncpy (sym->rname, str, SDCC_NAME_MAX);
+          sym->rname = internStr (str);
           addSet (&externs, sym);
         }                       // if
       sym->used++;
@@ -1426,7 +1426,7 @@ call_libraryfunc (char *name)
   if (!sym)
     {
       sym = newSymbol (name, 0);
-      strncpy (sym->rname, name, SDCC_NAME_MAX);
+      sym->rname = internStr (name);
       addSym (SymbolTab, sym, sym->rname, 0, 0, 0);
       addSet (&externs, sym);
     }                           // if
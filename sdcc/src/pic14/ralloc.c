@@ -1514,9 +1514,9 @@ selectSpil (iCode * ic, eBBlock * ebp, symbol * forSym)
         if ((selectS = liveRangesWith (lrcs, directSpilLoc, ebp, ic)))
         {
                 sym = leastUsedLR (selectS);
-                strcpy (sym->rname, (sym->usl.spillLoc->rname[0] ?
+                sym->rname = (sym->usl.spillLoc->rname[0] ?
                         sym->usl.spillLoc->rname :
-                sym->usl.spillLoc->name));
+                sym->usl.spillLoc->name);
                 sym->spildir = 1;
                 /* mark it as allocation required */
                 sym->usl.spillLoc->allocreq = 1;
@@ -2424,7 +2424,7 @@ regTypeNum (void)
                                         psym->type = sym->type;
                                         psym->etype = sym->etype;
                                         psym->psbase = ptrBaseRematSym (OP_SYMBOL (IC_LEFT (ic)));
-                                        strcpy (psym->rname, psym->name);
+                                        psym->rname = psym->name;
                                         sym->isspilt = 1;
                                         sym->usl.spillLoc = psym;
                                         continue;
@@ -3859,7 +3859,9 @@ pic14_assignRegisters (ebbIndex *ebbi)
   debugLog ("ebbs after optimizing:\n");
   dumpEbbsToDebug (ebbs, count);
 
+  timerBegin ("genCode");
   genpic14Code (ic);
+  timerEnd ("genCode");
 
   /* free up any _G.stackSpil locations allocated */
   applyToSet (_G.stackSpil, deallocStackSpil);
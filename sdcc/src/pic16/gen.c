@@ -2256,7 +2256,7 @@ pic16_testStackOverflow (void)
     symbol *sym;
 
     sym = newSymbol (GSTACK_TEST_NAME, 0);
-    SNPRINTF(sym->rname, sizeof(sym->rname), "%s", /*port->fun_prefix, */ GSTACK_TEST_NAME);
+    sym->rname = internStr (/*port->fun_prefix, */ GSTACK_TEST_NAME);
 //      strcpy(sym->rname, GSTACK_TEST_NAME);
     checkAddSym (&externs, sym);
   }
@@ -4287,7 +4287,7 @@ genDiv (iCode * ic)
             symbol *sym;
             sym = newSymbol (functions[op][0], 0);
             sym->used++;
-            strcpy (sym->rname, functions[op][0]);
+            sym->rname = internStr (functions[op][0]);
             checkAddSym (&externs, sym);
           }
 
@@ -4366,7 +4366,7 @@ genDiv (iCode * ic)
         symbol *sym;
         sym = newSymbol (functions[op][1], 0);
         sym->used++;
-        strcpy (sym->rname, functions[op][1]);
+        sym->rname = internStr (functions[op][1]);
         checkAddSym (&externs, sym);
       }
 
@@ -522,7 +522,7 @@ void pic16_callGenericPointerRW(int rw, int size)
     
     sym = newSymbol( buf, 0 );
     sym->used++;
-    strcpy(sym->rname, buf);
+    sym->rname = internStr (buf);
     checkAddSym(&externs, sym);
 }
 
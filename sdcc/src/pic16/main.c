@@ -243,11 +243,11 @@ do_pragma (int id, const char *name, const char *cp)
         addSet (&pic16_fix_udata, reg);
 
         sym = newSymbol ("stack", 0);
-        SNPRINTF(sym->rname, sizeof(sym->rname), "_%s", sym->name);
+        sym->rname = internPrintf ("_%s", sym->name);
         addSet (&publics, sym);
 
         sym = newSymbol ("stack_end", 0);
-        SNPRINTF(sym->rname, sizeof(sym->rname), "_%s", sym->name);
+        sym->rname = internPrintf ("_%s", sym->name);
         addSet (&publics, sym);
 
         initsfpnt = 1;    // force glue() to initialize stack/frame pointers */
@@ -336,7 +336,7 @@ do_pragma (int id, const char *name, const char *cp)
             addSet (&sectSyms, ssym);
 
             nsym = newSymbol ((char *)symname, 0);
-            strcpy(nsym->rname, ssym->name);
+            nsym->rname = internStr (ssym->name);
 
 #if 0
             checkAddSym (&publics, nsym);
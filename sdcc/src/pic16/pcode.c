@@ -8036,7 +8036,7 @@ static void pic16_convertLocalRegs2Support(pCode *pcstart, pCode *pcend, int cou
       symbol *sym;
 
         sym = newSymbol( fname[ entry?0:1 ], 0 );
-        strcpy(sym->rname, fname[ entry?0:1 ]);
+        sym->rname = internStr (fname[ entry?0:1 ]);
         checkAddSym(&externs, sym);
 
 //        fprintf(stderr, "%s:%d adding extern symbol %s in externs\n", __FILE__, __LINE__, fname[ entry?0:1 ]);
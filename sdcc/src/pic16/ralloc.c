@@ -1786,9 +1786,9 @@ selectSpil (iCode * ic, eBBlock * ebp, symbol * forSym)
   if ((selectS = liveRangesWith (lrcs, directSpilLoc, ebp, ic)))
     {
       sym = leastUsedLR (selectS);
-      strcpy (sym->rname, (SYM_SPIL_LOC (sym)->rname[0] ?
-                           SYM_SPIL_LOC (sym)->rname :
-                           SYM_SPIL_LOC (sym)->name));
+      sym->rname = (SYM_SPIL_LOC (sym)->rname[0] ?
+                    SYM_SPIL_LOC (sym)->rname :
+                    SYM_SPIL_LOC (sym)->name);
       sym->spildir = 1;
       /* mark it as allocation required */
       SYM_SPIL_LOC (sym)->allocreq = 1;
@@ -2785,7 +2785,7 @@ regTypeNum ()
           psym->type = sym->type;
           psym->etype = sym->etype;
           psym->psbase = ptrBaseRematSym (OP_SYMBOL (IC_LEFT (ic)));
-          strcpy (psym->rname, psym->name);
+          psym->rname = psym->name;
           sym->isspilt = 1;
           SYM_SPIL_LOC (sym) = psym;
           continue;
@@ -4508,7 +4508,9 @@ pic16_assignRegisters (ebbIndex * ebbi)
 
   _inRegAllocator = 0;
 
+  timerBegin ("genCode");
   genpic16Code (ic);
+  timerEnd ("genCode");
 
   /* free up any _G.stackSpil locations allocated */
   applyToSet (_G.stackSpil, deallocStackSpil);
@@ -7494,6 +7494,7 @@ genSTM8Code (iCode *lic)
 #if 0
       emit2 (";", "count: %f", ic->count);
 #endif
+      emitProfileProbe (ic);
       genSTM8iCode(ic);
 
 #if 0
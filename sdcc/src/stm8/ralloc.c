@@ -633,7 +633,9 @@ stm8_assignRegisters (ebbIndex * ebbi)
   stm8_extend_stack = stm8_call_stack_size > 255;
 
   /* Invoke optimal register allocator */
+  timerBegin ("ralloc2");
   ic = stm8_ralloc2_cc (ebbi);
+  timerEnd ("ralloc2");
 
   /* Get spilllocs for all variables that have not been placed completely in regs */
   RegFix (ebbs, count);
@@ -656,7 +658,9 @@ stm8_assignRegisters (ebbIndex * ebbi)
           stm8_extend_stack = TRUE;
 
           /* Invoke optimal register allocator */
+          timerBegin ("ralloc2");
           ic = stm8_ralloc2_cc (ebbi);
+          timerEnd ("ralloc2");
 
           /* Get spilllocs for all variables that have not been placed completely in regs */
           RegFix (ebbs, count);
@@ -671,6 +675,8 @@ stm8_assignRegisters (ebbIndex * ebbi)
       dumpLiveRanges (DUMP_LRANGE, liveRanges);
     }
 
+  timerBegin ("genCode");
   genSTM8Code (ic);
+  timerEnd ("genCode");
 }
 
@@ -574,7 +574,10 @@ iCode *stm8_ralloc2_cc(ebbIndex *ebbi)
 
   guessCounts (ic, ebbi);
 
+  static allocs_budget budget("register allocation", 0.6, 40000);
+  budget.begin(tree_decomposition);
   stm8_assignment_optimal = !tree_dec_ralloc(tree_decomposition, control_flow_graph, conflict_graph);
+  budget.end();
 
   return(ic);
 }
@@ -236,6 +236,13 @@ static struct
     allocTrace trace;
   } lines;
 
+  struct
+  {
+    /** The lines saving and restoring the registers of an interrupt routine. */
+    set *saves;
+    set *restores;
+  } isr;
+
   struct
   {
     allocTrace aops;
@@ -311,18 +318,69 @@ z80_init_asmops (void)
 }
 
 static bool regalloc_dry_run;
-static unsigned char regalloc_dry_run_cost;
+static unsigned int regalloc_dry_run_cost;
+static unsigned int regalloc_dry_run_cycles;
+static unsigned int regalloc_dry_run_timed;     /* Bytes of regalloc_dry_run_cost that come with cycles. */
 
 static void
 cost(unsigned int bytes, unsigned int cycles)
 {
   regalloc_dry_run_cost += bytes;
+  regalloc_dry_run_cycles += cycles;
+  regalloc_dry_run_timed += bytes;
 }
 
 static void
 cost2(unsigned int bytes, unsigned int cycles_z80, unsigned int cycles_z180, unsigned int cycles_r2k, unsigned int cycles_gbz80, unsigned int cycles_tlcs90)
 {
-  regalloc_dry_run_cost += bytes;
+  cost (bytes, IS_Z180 ? cycles_z180 : IS_RAB ? cycles_r2k : IS_GB ? cycles_gbz80 : IS_TLCS90 ? cycles_tlcs90 : cycles_z80);
+}
+
+/* Cycles of the basic instructions emit3 () generates, by operand kind.
+   "ix" stands for an (ix+d) operand, which gbz80 addresses using
+   ld hl, d(sp) instead. */
+enum cycle_kind
+{
+  CY_R,                         /* ld r, r / op a, r / inc r */
+  CY_N,                         /* ld r, #n / op a, #n */
+  CY_HL,                        /* ld r, (hl) / ld (hl), r / op a, (hl) */
+  CY_IX,                        /* ld r, (ix+d) / ld (ix+d), r / op a, (ix+d) */
+  CY_RMW_HL,                    /* inc (hl) / ld (hl), #n */
+  CY_RMW_IX,                    /* inc (ix+d) / ld (ix+d), #n */
+  CY_CB_R,                      /* rl r */
+  CY_CB_HL,                     /* rl (hl) */
+  CY_CB_IX,                     /* rl (ix+d) */
+  CY_LD_HL,                     /* ld hl, #nn */
+  CY_LD_IY,                     /* ld iy, #nn */
+  CY_IO,                        /* in a, (n) / out (n), a */
+  CY_ACC,                       /* cpl / rla */
+  CY_NEG,                       /* neg */
+  CY_NUM
+};
+
+static const unsigned char cycle_table[][CY_NUM] =
+{
+  /* R  N  HL  IX RMW_HL RMW_IX CB_R CB_HL CB_IX LD_HL LD_IY IO ACC NEG */
+  {  4, 7,  7, 19,    11,    23,   8,   15,   23,   10,   14, 11,  4,  8 },    /* Z80 */
+  {  4, 6,  6, 14,    10,    18,   7,   13,   19,    9,   12,  9,  3,  6 },    /* Z180 */
+  {  2, 4,  5,  9,     8,    12,   4,   10,   13,    6,    8, 11,  2,  4 },    /* R2K, R3KA */
+  {  4, 8,  8, 20,    12,    24,   8,   16,   28,   12,   12, 12,  4,  8 },    /* GBZ80 */
+  {  4, 4,  6, 10,     8,    12,   4,   10,   12,    6,    6,  8,  2,  4 },    /* TLCS90 */
+};
+
+/* Average cycles per byte, for the code whose cycles are not known. */
+static const unsigned char cycles_per_byte[] = { 4, 3, 2, 4, 2 };
+
+static int
+cycle_target (void)
+{
+  return (IS_Z180 ? 1 : IS_RAB ? 2 : IS_GB ? 3 : IS_TLCS90 ? 4 : 0);
+}
+
+static unsigned int
+cy (enum cycle_kind kind)
+{
+  return (cycle_table[cycle_target ()][kind]);
 }
 
 /*-----------------------------------------------------------------*/
@@ -905,16 +963,237 @@ emit3Cost (enum asminst inst, const asmop *op1, int offset1, const asmop *op2, i
   return (0);
 }
 
+/* Cycles of the code ld_cost () counts the bytes of. */
+static unsigned int
+ld_cycles (const asmop *op1, const asmop *op2)
+{
+  AOP_TYPE op2type;
+  bool a;
+
+  if (op2->type == AOP_REG || op2->type == AOP_HLREG || op2->type == AOP_DUMMY)
+    {
+      const asmop *tmp = op1;
+      op1 = op2;
+      op2 = tmp;
+    }
+  op2type = op2->type;
+  a = aopInReg (op1, 0, A_IDX) || op1->type == AOP_DUMMY;
+
+  switch (op1->type)
+    {
+    case AOP_REG:
+    case AOP_HLREG:
+    case AOP_DUMMY:
+      switch (op2type)
+        {
+        case AOP_REG:
+        case AOP_HLREG:
+        case AOP_DUMMY:
+          return (cy (CY_R));
+        case AOP_IMMD:
+        case AOP_LIT:
+          return (cy (CY_N));
+        case AOP_SFR:
+          return (cy (CY_IO) + (a ? 0 : cy (CY_R)));
+        case AOP_STK:
+          return (cy (CY_IX));
+        case AOP_HL:
+          return (cy (CY_LD_HL) + cy (CY_HL));
+        case AOP_IY:
+        case AOP_EXSTK:
+          return (cy (CY_LD_IY) + cy (CY_IX));
+        case AOP_PAIRPTR:
+          if (op2->aopu.aop_pairId == PAIR_IY || op2->aopu.aop_pairId == PAIR_IX)
+            return (cy (CY_IX));
+          if (op2->aopu.aop_pairId == PAIR_BC || op2->aopu.aop_pairId == PAIR_DE)
+            return (cy (CY_HL) + (a ? 0 : cy (CY_R)));
+          return (cy (CY_HL));
+        default:
+          break;
+        }
+      break;
+    case AOP_SFR:
+      switch (op2type)
+        {
+        case AOP_IMMD:
+        case AOP_LIT:
+          return (cy (CY_N) + cy (CY_IO));
+        case AOP_STK:
+          return (cy (CY_IX) + cy (CY_IO));
+        case AOP_HL:
+          return (cy (CY_LD_HL) + cy (CY_HL) + cy (CY_IO));
+        case AOP_SFR:
+          return (2 * cy (CY_IO));
+        case AOP_IY:
+        case AOP_EXSTK:
+          return (cy (CY_LD_IY) + cy (CY_IX) + cy (CY_IO));
+        default:
+          break;
+        }
+      break;
+    case AOP_IY:
+    case AOP_EXSTK:
+      switch (op2type)
+        {
+        case AOP_IMMD:
+        case AOP_LIT:
+          return (cy (CY_LD_IY) + cy (CY_RMW_IX));
+        case AOP_SFR:
+          return (cy (CY_IO) + cy (CY_LD_IY) + cy (CY_IX));
+        case AOP_STK:
+          return (cy (CY_IX) + cy (CY_LD_IY) + cy (CY_IX));
+        case AOP_HL:
+          return (cy (CY_LD_HL) + cy (CY_HL) + cy (CY_LD_IY) + cy (CY_IX));
+        case AOP_IY:
+        case AOP_EXSTK:
+          return (2 * (cy (CY_LD_IY) + cy (CY_IX)));
+        default:
+          break;
+        }
+      break;
+    case AOP_STK:
+      switch (op2type)
+        {
+        case AOP_IMMD:
+        case AOP_LIT:
+          return (cy (CY_RMW_IX));
+        case AOP_SFR:
+          return (cy (CY_IO) + cy (CY_IX));
+        case AOP_STK:
+          return (2 * cy (CY_IX));
+        case AOP_HL:
+          return (cy (CY_LD_HL) + cy (CY_HL) + cy (CY_IX));
+        case AOP_IY:
+        case AOP_EXSTK:
+          return (cy (CY_LD_IY) + 2 * cy (CY_IX));
+        case AOP_PAIRPTR:
+          if (op2->aopu.aop_pairId == PAIR_IY || op2->aopu.aop_pairId == PAIR_IX)
+            return (2 * cy (CY_IX));
+          return (cy (CY_HL) + cy (CY_IX));
+        default:
+          break;
+        }
+      break;
+    case AOP_HL:
+      switch (op2type)
+        {
+        case AOP_IMMD:
+        case AOP_LIT:
+          return (cy (CY_LD_HL) + cy (CY_RMW_HL));
+        case AOP_STK:
+          return (cy (CY_IX) + cy (CY_LD_HL) + cy (CY_HL));
+        case AOP_SFR:
+          return (cy (CY_IO) + cy (CY_LD_HL) + cy (CY_HL));
+        case AOP_HL:
+          return (2 * (cy (CY_LD_HL) + cy (CY_HL)));
+        case AOP_IY:
+        case AOP_EXSTK:
+          return (cy (CY_LD_IY) + cy (CY_IX) + cy (CY_LD_HL) + cy (CY_HL));
+        default:
+          break;
+        }
+      break;
+    default:
+      break;
+    }
+  return (ld_cost (op1, op2) * cycles_per_byte[cycle_target ()]); // Fallback
+}
+
+/* Cycles of an 8-bit operation, op2 being the operand or, for inc and dec, the one modified. */
+static unsigned int
+op8_cycles (const asmop *op2, bool rmw)
+{
+  switch (op2->type)
+    {
+    case AOP_REG:
+    case AOP_HLREG:
+    case AOP_DUMMY:
+      return (cy (CY_R));
+    case AOP_IMMD:
+    case AOP_LIT:
+      return (cy (CY_N));
+    case AOP_STK:
+      return (cy (rmw ? CY_RMW_IX : CY_IX));
+    case AOP_HL:
+      return (cy (CY_LD_HL) + cy (rmw ? CY_RMW_HL : CY_HL));
+    case AOP_IY:
+    case AOP_EXSTK:
+      return (cy (CY_LD_IY) + cy (rmw ? CY_RMW_IX : CY_IX));
+    case AOP_PAIRPTR:
+      if (op2->aopu.aop_pairId == PAIR_IY || op2->aopu.aop_pairId == PAIR_IX)
+        return (cy (rmw ? CY_RMW_IX : CY_IX));
+      return (cy (rmw ? CY_RMW_HL : CY_HL));
+    default:
+      return (op8_cost (op2) * cycles_per_byte[cycle_target ()]); // Fallback
+    }
+}
+
+static unsigned int
+bit8_cycles (const asmop *op1)
+{
+  switch (op1->type)
+    {
+    case AOP_REG:
+    case AOP_HLREG:
+    case AOP_DUMMY:
+      return (cy (CY_CB_R));
+    case AOP_STK:
+      return (cy (CY_CB_IX));
+    case AOP_HL:
+      return (cy (CY_LD_HL) + cy (CY_CB_HL));
+    case AOP_IY:
+    case AOP_EXSTK:
+      return (cy (CY_LD_IY) + cy (CY_CB_IX));
+    default:
+      return (bit8_cost (op1) * cycles_per_byte[cycle_target ()]); // Fallback
+    }
+}
+
+static unsigned int
+emit3Cycles (enum asminst inst, const asmop *op1, int offset1, const asmop *op2, int offset2)
+{
+  if (op2 && offset2 >= op2->size)
+    op2 = ASMOP_ZERO;
+
+  switch (inst)
+    {
+    case A_CPL:
+    case A_RLA:
+    case A_RLCA:
+    case A_RRA:
+    case A_RRCA:
+      return (cy (CY_ACC));
+    case A_NEG:
+      return (cy (CY_NEG));
+    case A_LD:
+      return (ld_cycles (op1, op2));
+    case A_ADD:
+    case A_ADC:
+    case A_AND:
+    case A_CP:
+    case A_OR:
+    case A_SBC:
+    case A_SUB:
+    case A_XOR:
+      return (op8_cycles (op2, FALSE));
+    case A_DEC:
+    case A_INC:
+      return (op8_cycles (op1, TRUE));
+    default:
+      return (bit8_cycles (op1));
+    }
+}
+
 static void
 emit3_o (enum asminst inst, asmop *op1, int offset1, asmop *op2, int offset2)
 {
-  unsigned char cost;
+  unsigned int saved_cost;
 
-  regalloc_dry_run_cost += emit3Cost (inst, op1, offset1, op2, offset2);
+  cost (emit3Cost (inst, op1, offset1, op2, offset2), emit3Cycles (inst, op1, offset1, op2, offset2));
   if (regalloc_dry_run)
     return;
 
-  cost = regalloc_dry_run_cost;
+  saved_cost = regalloc_dry_run_cost;
   if (!op1)
     emit2 ("%s", asminstnames[inst]);
   else if (!op2)
@@ -927,7 +1206,7 @@ emit3_o (enum asminst inst, asmop *op1, int offset1, asmop *op2, int offset2)
       Safe_free (l);
     }
 
-  regalloc_dry_run_cost = cost;
+  regalloc_dry_run_cost = saved_cost;
   //emitDebug(";emit3_o cost: %d total so far: %d", (int)emit3Cost(inst, op1, offset1, op2, offset2), (int)cost);
 }
 
@@ -2821,7 +3100,7 @@ aopPut (asmop * aop, const char *s, int offset)
 static void
 aopPut3 (asmop *op1, int offset1, asmop *op2, int offset2)
 {
-  unsigned char cost = regalloc_dry_run_cost;
+  unsigned int saved_cost = regalloc_dry_run_cost;
   int fp_offset=0;
   int sp_offset=0;
 
@@ -2845,7 +3124,8 @@ aopPut3 (asmop *op1, int offset1, asmop *op2, int offset2)
         aopPut (op1, aopGet (op2, offset2, FALSE), offset1);
     }
 
-  regalloc_dry_run_cost = cost + ld_cost (op1, offset2 < op2->size ? op2 : ASMOP_ZERO);
+  regalloc_dry_run_cost = saved_cost;
+  cost (ld_cost (op1, offset2 < op2->size ? op2 : ASMOP_ZERO), ld_cycles (op1, offset2 < op2->size ? op2 : ASMOP_ZERO));
 }
 
 // Move, but try not to.
@@ -3613,6 +3893,26 @@ restoreRegs (bool iy, bool de, bool bc, bool hl, const operand *result)
     }
 }
 
+/*-----------------------------------------------------------------*/
+/* callPreserves - true if the call ic does not change register idx */
+/*-----------------------------------------------------------------*/
+static bool
+callPreserves (const iCode * ic, int idx)
+{
+  sym_link *dtype = operandType (IC_LEFT (ic));
+  sym_link *ftype = IS_FUNCPTR (dtype) ? dtype->next : dtype;
+  const symbol *func;
+
+  if (ftype->funcAttrs.preserved_regs[idx])
+    return TRUE;
+
+  /* The code of functions generated earlier in this file is known. */
+  if (ic->op != CALL || !IS_SYMOP (IC_LEFT (ic)) || IFFUNC_ISBANKEDCALL (dtype))
+    return FALSE;
+  func = OP_SYMBOL_CONST (IC_LEFT (ic));
+  return func->regsClobbered && !bitVectBitValue (func->regsClobbered, idx);
+}
+
 static void
 _saveRegsForCall (const iCode * ic, bool dontsaveIY)
 {
@@ -3638,9 +3938,6 @@ _saveRegsForCall (const iCode * ic, bool dontsaveIY)
      o ...
    */
 
-  sym_link *dtype = operandType (IC_LEFT (ic));
-  sym_link *ftype = IS_FUNCPTR (dtype) ? dtype->next : dtype;
-
   if (_G.saves.saved == FALSE)
     {
       bool push_bc, push_de, push_hl, push_iy;
@@ -3665,10 +3962,10 @@ _saveRegsForCall (const iCode * ic, bool dontsaveIY)
         }
       else
         {
-          push_bc = bitVectBitValue (ic->rSurv, B_IDX) && !ftype->funcAttrs.preserved_regs[B_IDX] || bitVectBitValue (ic->rSurv, C_IDX) && !ftype->funcAttrs.preserved_regs[C_IDX];
-          push_de = bitVectBitValue (ic->rSurv, D_IDX) && !ftype->funcAttrs.preserved_regs[D_IDX] || bitVectBitValue (ic->rSurv, E_IDX) && !ftype->funcAttrs.preserved_regs[E_IDX];
-          push_hl = bitVectBitValue (ic->rSurv, H_IDX) || bitVectBitValue (ic->rSurv, L_IDX);
-          push_iy = !dontsaveIY && (bitVectBitValue (ic->rSurv, IYH_IDX) || bitVectBitValue (ic->rSurv, IYL_IDX));
+          push_bc = bitVectBitValue (ic->rSurv, B_IDX) && !callPreserves (ic, B_IDX) || bitVectBitValue (ic->rSurv, C_IDX) && !callPreserves (ic, C_IDX);
+          push_de = bitVectBitValue (ic->rSurv, D_IDX) && !callPreserves (ic, D_IDX) || bitVectBitValue (ic->rSurv, E_IDX) && !callPreserves (ic, E_IDX);
+          push_hl = bitVectBitValue (ic->rSurv, H_IDX) && !callPreserves (ic, H_IDX) || bitVectBitValue (ic->rSurv, L_IDX) && !callPreserves (ic, L_IDX);
+          push_iy = !dontsaveIY && (bitVectBitValue (ic->rSurv, IYH_IDX) && !callPreserves (ic, IYH_IDX) || bitVectBitValue (ic->rSurv, IYL_IDX) && !callPreserves (ic, IYL_IDX));
         }
 
       if (push_hl)
@@ -4228,6 +4525,79 @@ resultRemat (const iCode * ic)
   return 0;
 }
 
+/*-----------------------------------------------------------------*/
+/* linesSince - adds the lines emitted after last to lines         */
+/*-----------------------------------------------------------------*/
+static void
+linesSince (lineNode *last, set **lines)
+{
+  lineNode *line;
+
+  if (regalloc_dry_run)
+    return;
+
+  for (line = last ? last->next : genLine.lineHead; line; line = line->next)
+    addSet (lines, line);
+}
+
+/*-----------------------------------------------------------------*/
+/* trimInterruptSaves - an interrupt routine only saves the        */
+/*   registers changed by its code and the functions it calls      */
+/*-----------------------------------------------------------------*/
+static void
+trimInterruptSaves (void)
+{
+  set *skip = unionSets (_G.isr.saves, _G.isr.restores, THROW_NONE);
+  bitVect *clobbered;
+  lineNode *line, *next;
+  int found = 0;
+
+  /* Leave them alone if the peephole optimizer changed any of them. */
+  for (line = genLine.lineHead; line; line = line->next)
+    found += isinSet (skip, line);
+
+  if (skip && found == elementsInSet (skip))
+    {
+      clobbered = z80RegsClobbered (genLine.lineHead, skip);
+
+      for (line = genLine.lineHead; line; line = next)
+        {
+          const char *p;
+          int i;
+
+          next = line->next;
+          if (!isinSet (skip, line))
+            continue;
+
+          for (p = line->line; *p && !isspace (*p); p++);
+          while (isspace (*p))
+            p++;
+          for (i = PAIR_AF; i < NUM_PAIRS; i++)
+            if (!strcmp (p, _pairs[i].name))
+              break;
+          if (i == NUM_PAIRS ||
+              _pairs[i].l_idx >= 0 && bitVectBitValue (clobbered, _pairs[i].l_idx) ||
+              _pairs[i].h_idx >= 0 && bitVectBitValue (clobbered, _pairs[i].h_idx))
+            continue;
+
+          if (line->prev)
+            line->prev->next = next;
+          else
+            genLine.lineHead = next;
+          if (next)
+            next->prev = line->prev;
+          else
+            genLine.lineCurr = line->prev;
+        }
+
+      freeBitVect (clobbered);
+    }
+
+  deleteSet (&skip);
+  deleteSet (&_G.isr.saves);
+  deleteSet (&_G.isr.restores);
+}
+
 /*-----------------------------------------------------------------*/
 /* genFunction - generated code for function entry                 */
 /*-----------------------------------------------------------------*/
@@ -4281,12 +4651,16 @@ genFunction (const iCode * ic)
      then save all potentially used registers. */
   if (IFFUNC_ISISR (sym->type))
     {
+      lineNode *last;
+
       if (!IFFUNC_ISCRITICAL (sym->type))
         {
           emit2 ("!ei");
         }
 
+      last = genLine.lineCurr;
       emit2 ("!pusha");
+      linesSince (last, &_G.isr.saves);
     }
   else
     {
@@ -4458,7 +4832,12 @@ genEndFunction (iCode * ic)
   /* if this is an interrupt service routine
      then save all potentially used registers. */
   if (IFFUNC_ISISR (sym->type))
-    emit2 ("!popa");
+    {
+      lineNode *last = genLine.lineCurr;
+
+      emit2 ("!popa");
+      linesSince (last, &_G.isr.restores);
+    }
   else
     {
       /* This is a non-ISR function.
@@ -12164,11 +12543,18 @@ genZ80iCode (iCode * ic)
     }
 }
 
-unsigned char
+/* The cost of the code for ic: its size in bytes. With --opt-code-speed,
+   the cycles, weighted by the execution count of ic, are added in units
+   of the time taken to fetch two bytes. */
+float
 dryZ80iCode (iCode * ic)
 {
+  unsigned int cycles;
+
   regalloc_dry_run = TRUE;
   regalloc_dry_run_cost = 0;
+  regalloc_dry_run_cycles = 0;
+  regalloc_dry_run_timed = 0;
 
   /* Hack */
   if (IS_GB)
@@ -12196,7 +12582,14 @@ dryZ80iCode (iCode * ic)
       spillPair (pairId);
   }
 
-  return (regalloc_dry_run_cost);
+  if (!optimize.codeSpeed || optimize.codeSize)
+    return (regalloc_dry_run_cost);
+
+  cycles = regalloc_dry_run_cycles;
+  if (regalloc_dry_run_cost > regalloc_dry_run_timed)
+    cycles += (regalloc_dry_run_cost - regalloc_dry_run_timed) * cycles_per_byte[cycle_target ()];
+
+  return (regalloc_dry_run_cost + cycles * ic->count / (2 * cycles_per_byte[cycle_target ()]));
 }
 
 #ifdef DEBUG_DRY_COST
@@ -12269,6 +12662,7 @@ genZ80Code (iCode * lic)
           emit2 (";ic:%d: %s", ic->key, iLine);
           dbuf_free (iLine);
         }
+      emitProfileProbe (ic);
       regalloc_dry_run_cost = 0;
       genZ80iCode (ic);
     }
@@ -12279,6 +12673,29 @@ genZ80Code (iCode * lic)
   if (!options.nopeep)
     peepHole (&genLine.lineHead);
 
+  if (_G.isr.saves || _G.isr.restores)
+    trimInterruptSaves ();
+
+  /* Calls of this function from later ones don't need to save the other registers. */
+  if (currFunc)
+    {
+      static const char *const names[] = {"a", "c", "b", "e", "d", "l", "h", "iyl", "iyh"};
+      struct dbuf_s dbuf;
+      int i;
+
+      freeBitVect (currFunc->regsClobbered);
+      currFunc->regsClobbered = z80RegsClobbered (genLine.lineHead, NULL);
+
+      /* For __preserves_regs on declarations in other files */
+      dbuf_init (&dbuf, 64);
+      for (i = 0; i <= (IS_GB ? H_IDX : IYH_IDX); i++)
+        if (!bitVectBitValue (currFunc->regsClobbered, i))
+          dbuf_printf (&dbuf, "%s%s", dbuf_get_length (&dbuf) ? ", " : "", names[i]);
+      if (dbuf_get_length (&dbuf))
+        emitDebug ("; Registers preserved: %s", dbuf_c_str (&dbuf));
+      dbuf_destroy (&dbuf);
+    }
+
   /* This is unfortunate */
   /* now do the actual printing */
   {
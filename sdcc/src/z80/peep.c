@@ -712,6 +712,7 @@ z80SurelyWrites(const lineNode *pl, const char *what)
       int i;
       const symbol *f = findSym (SymbolTab, 0, pl->line + 6);
       const bool *preserved_regs;
+      bool unchanged_regs[IYH_IDX + 1];
 
       if(!strcmp(what, "ix"))
         return FALSE;
@@ -726,7 +727,14 @@ z80SurelyWrites(const lineNode *pl, const char *what)
              }
         }
 
-      if(f)
+      // Functions generated earlier in this file
+      if(f && f->regsClobbered)
+        {
+          for (i = 0; i <= IYH_IDX; i++)
+            unchanged_regs[i] = !bitVectBitValue(f->regsClobbered, i);
+          preserved_regs = unchanged_regs;
+        }
+      else if(f)
           preserved_regs = f->type->funcAttrs.preserved_regs;
       else // Err on the safe side.
         preserved_regs = z80_regs_preserved_in_calls_from_current_function;
@@ -1345,3 +1353,297 @@ bool z80symmParmStack (void)
   return z80_symmParm_in_calls_from_current_function;
 }
 
+
+#define REGS_ALL ((1 << (IYH_IDX + 1)) - 1)
+#define REGS_A (1 << A_IDX)
+#define REGS_B (1 << B_IDX)
+#define REGS_BC ((1 << B_IDX) | (1 << C_IDX))
+#define REGS_DE ((1 << D_IDX) | (1 << E_IDX))
+#define REGS_HL ((1 << H_IDX) | (1 << L_IDX))
+#define REGS_IY ((1 << IYH_IDX) | (1 << IYL_IDX))
+
+/*-----------------------------------------------------------------*/
+/* operandRegs - the registers an operand written to changes, the  */
+/*   flags count as a. Memory operands change nothing, except the  */
+/*   gbz80 (hl+) and (hl-).                                        */
+/*-----------------------------------------------------------------*/
+static unsigned int
+operandRegs (const char *op)
+{
+  static const struct
+  {
+    const char *name;
+    unsigned int regs;
+  } regs[] =
+  {
+    {"a", REGS_A}, {"af", REGS_A}, {"af'", REGS_A},
+    {"b", REGS_B}, {"c", 1 << C_IDX}, {"bc", REGS_BC},
+    {"d", 1 << D_IDX}, {"e", 1 << E_IDX}, {"de", REGS_DE},
+    {"h", 1 << H_IDX}, {"l", 1 << L_IDX}, {"hl", REGS_HL},
+    {"iyh", 1 << IYH_IDX}, {"iyl", 1 << IYL_IDX}, {"iy", REGS_IY},
+  };
+  int i;
+
+  if (op[0] == '(')
+    return (!STRNCASECMP (op, "(hl+", 4) || !STRNCASECMP (op, "(hl-", 4) ||
+            !STRNCASECMP (op, "(hli)", 5) || !STRNCASECMP (op, "(hld)", 5)) ? REGS_HL : 0;
+
+  for (i = 0; i < sizeof (regs) / sizeof (regs[0]); i++)
+    if (!STRCASECMP (op, regs[i].name))
+      return regs[i].regs;
+
+  return 0;
+}
+
+/*-----------------------------------------------------------------*/
+/* callRegs - the registers a call of name might change            */
+/*-----------------------------------------------------------------*/
+static unsigned int
+callRegs (const char *name)
+{
+  const symbol *f;
+  unsigned int regs = REGS_ALL;
+  int i;
+
+  /* the !enters helper only uses hl for its return address */
+  if (!strcmp (name, "___sdcc_enter_ix"))
+    return REGS_HL;
+
+  for (i = 0; i < sizeof (special_funcs) / (3 * sizeof (char *)); ++i)
+    if (!strcmp (name, special_funcs[i][0] + 5))
+      {
+        const char *p;
+
+        for (p = special_funcs[i][2]; *p; p++)
+          {
+            char reg[2] = {*p, '\0'};
+
+            regs &= ~(*p == 'y' ? REGS_IY : operandRegs (reg));
+          }
+        return regs;
+      }
+
+  if (name[0] != '_' || !(f = findSym (SymbolTab, 0, name + 1)) || !IS_FUNC (f->type))
+    return REGS_ALL;
+
+  /* Generated earlier in this file? */
+  if (f->regsClobbered)
+    {
+      for (regs = 0, i = 0; i <= IYH_IDX; i++)
+        if (bitVectBitValue (f->regsClobbered, i))
+          regs |= 1 << i;
+      return regs;
+    }
+
+  for (i = 0; i <= IYH_IDX; i++)
+    if (f->type->funcAttrs.preserved_regs[i])
+      regs &= ~(1 << i);
+  return regs;
+}
+
+static int
+labelEq (void *label1, void *label2)
+{
+  return !strcmp (label1, label2);
+}
+
+/*-----------------------------------------------------------------*/
+/* lineRegs - the registers an instruction might change. Jumps to  */
+/*   labels not in labels are treated as tail calls, unknown       */
+/*   instructions change everything.                               */
+/*-----------------------------------------------------------------*/
+static unsigned int
+lineRegs (const lineNode *pl, set *labels)
+{
+  /* instructions that change only the registers named here */
+  static const struct
+  {
+    const char *name;
+    unsigned int regs;
+  } fixed[] =
+  {
+    {"nop", 0}, {"halt", 0}, {"di", 0}, {"ei", 0}, {"im", 0}, {"out", 0}, {"push", 0},
+    {"ret", 0}, {"reti", 0}, {"retn", 0}, {"stop", 0},
+    {"cp", REGS_A}, {"bit", REGS_A}, {"scf", REGS_A}, {"ccf", REGS_A}, {"tst", REGS_A},
+    {"sub", REGS_A}, {"and", REGS_A}, {"or", REGS_A}, {"xor", REGS_A}, {"neg", REGS_A},
+    {"cpl", REGS_A}, {"daa", REGS_A}, {"rla", REGS_A}, {"rra", REGS_A}, {"rlca", REGS_A},
+    {"rrca", REGS_A}, {"rld", REGS_A}, {"rrd", REGS_A},
+    {"djnz", REGS_B},
+    {"ldi", REGS_BC | REGS_DE | REGS_HL}, {"ldd", REGS_BC | REGS_DE | REGS_HL},
+    {"ldir", REGS_BC | REGS_DE | REGS_HL}, {"lddr", REGS_BC | REGS_DE | REGS_HL},
+    {"cpi", REGS_A | REGS_BC | REGS_HL}, {"cpd", REGS_A | REGS_BC | REGS_HL},
+    {"cpir", REGS_A | REGS_BC | REGS_HL}, {"cpdr", REGS_A | REGS_BC | REGS_HL},
+    {"ini", REGS_A | REGS_BC | REGS_HL}, {"ind", REGS_A | REGS_BC | REGS_HL},
+    {"inir", REGS_A | REGS_BC | REGS_HL}, {"indr", REGS_A | REGS_BC | REGS_HL},
+    {"outi", REGS_A | REGS_BC | REGS_HL}, {"outd", REGS_A | REGS_BC | REGS_HL},
+    {"otir", REGS_A | REGS_BC | REGS_HL}, {"otdr", REGS_A | REGS_BC | REGS_HL},
+    {"otim", REGS_A | REGS_BC | REGS_HL}, {"otdm", REGS_A | REGS_BC | REGS_HL},
+    {"otimr", REGS_A | REGS_BC | REGS_HL}, {"otdmr", REGS_A | REGS_BC | REGS_HL},
+    {"exx", REGS_BC | REGS_DE | REGS_HL},
+  };
+  /* instructions that change their first operand, and the flags if set */
+  static const struct
+  {
+    const char *name;
+    bool flags;
+  } first[] =
+  {
+    {"ld", FALSE}, {"pop", FALSE}, {"ldh", FALSE}, {"mlt", FALSE},
+    {"inc", TRUE}, {"dec", TRUE}, {"add", TRUE}, {"adc", TRUE}, {"sbc", TRUE},
+    {"in", TRUE}, {"in0", TRUE}, {"ldhl", TRUE},
+    {"rl", TRUE}, {"rr", TRUE}, {"rlc", TRUE}, {"rrc", TRUE}, {"sla", TRUE},
+    {"sra", TRUE}, {"srl", TRUE}, {"sll", TRUE}, {"sli", TRUE}, {"swap", TRUE},
+  };
+  char mnem[8], buf[128];
+  const char *p = pl->line;
+  char *ops[4];
+  unsigned int regs;
+  int nops, depth, i;
+  size_t len;
+
+  if (!p || pl->isComment || pl->isDebug || pl->isLabel)
+    return 0;
+
+  /* Inline assembler might start with a label of its own */
+  while (isspace (*p))
+    p++;
+  for (len = 0; isalnum (p[len]) || p[len] == '_' || p[len] == '$' || p[len] == '.'; len++);
+  if (len && p[len] == ':')
+    for (p += len + 1; *p == ':' || isspace (*p); p++);
+
+  if (!*p || *p == ';')
+    return 0;
+
+  for (len = 0; isalnum (p[len]); len++);
+  if (!len || len >= sizeof (mnem) || (p[len] && !isspace (p[len]) && p[len] != ';'))
+    return REGS_ALL;
+  for (i = 0; i < len; i++)
+    mnem[i] = tolower (p[i]);
+  mnem[len] = '\0';
+
+  /* Split the operands at the commas outside of parentheses */
+  for (p += len; isspace (*p); p++);
+  strncpyz (buf, p, sizeof (buf));
+  if (strlen (p) >= sizeof (buf))
+    return REGS_ALL;
+  for (nops = 0, depth = 0, ops[0] = buf, i = 0; buf[i] && buf[i] != ';'; i++)
+    if (buf[i] == '(')
+      depth++;
+    else if (buf[i] == ')')
+      depth--;
+    else if (buf[i] == ',' && !depth)
+      {
+        if (nops == 3)
+          return REGS_ALL;
+        buf[i] = '\0';
+        ops[++nops] = buf + i + 1;
+      }
+  buf[i] = '\0';
+  if (*ops[0])
+    nops++;
+  for (i = 0; i < nops; i++)
+    {
+      char *end;
+
+      while (isspace (*ops[i]))
+        ops[i]++;
+      for (end = ops[i] + strlen (ops[i]); end > ops[i] && isspace (end[-1]); end--);
+      *end = '\0';
+    }
+
+  /* gbz80 post-increment and -decrement in any operand */
+  for (regs = 0, i = 0; i < nops; i++)
+    if (ops[i][0] == '(')
+      regs |= operandRegs (ops[i]);
+
+  for (i = 0; i < sizeof (fixed) / sizeof (fixed[0]); i++)
+    if (!strcmp (mnem, fixed[i].name))
+      {
+        /* gbz80 ldi a, (hl) etc. */
+        if (nops)
+          regs |= operandRegs (ops[0]);
+        return regs | fixed[i].regs;
+      }
+
+  for (i = 0; i < sizeof (first) / sizeof (first[0]); i++)
+    if (!strcmp (mnem, first[i].name))
+      {
+        if (!nops)
+          return REGS_ALL;
+        /* add, adc and sbc also have a short form with a implied */
+        if (nops == 1 && (!strcmp (mnem, "add") || !strcmp (mnem, "adc") || !strcmp (mnem, "sbc")))
+          regs |= REGS_A;
+        else
+          regs |= operandRegs (ops[0]);
+        return regs | (first[i].flags ? REGS_A : 0);
+      }
+
+  if (!strcmp (mnem, "ex") && nops == 2)
+    return regs | operandRegs (ops[0]) | operandRegs (ops[1]);
+
+  /* set and res change their last operands */
+  if (!strcmp (mnem, "set") || !strcmp (mnem, "res"))
+    {
+      for (i = 1; i < nops; i++)
+        regs |= operandRegs (ops[i]);
+      return regs;
+    }
+
+  if ((!strcmp (mnem, "jp") || !strcmp (mnem, "jr")) && nops)
+    {
+      const char *target = ops[nops - 1];
+
+      /* The code generator only jumps through registers for jump tables */
+      if (target[0] == '(')
+        return pl->isInline ? REGS_ALL : regs;
+      /* Temporary labels are local to the function */
+      if (target[strlen (target) - 1] == '$' || isinSetWith (labels, (void *) target, labelEq))
+        return regs;
+      return regs | callRegs (target);
+    }
+
+  if (!strcmp (mnem, "call") && nops)
+    return regs | callRegs (ops[nops - 1]);
+
+  return REGS_ALL;
+}
+
+/*-----------------------------------------------------------------*/
+/* z80RegsClobbered - the registers the code from head might change */
+/*   including those changed by the functions it calls. Lines in   */
+/*   skip are not looked at.                                       */
+/*-----------------------------------------------------------------*/
+bitVect *
+z80RegsClobbered (lineNode *head, set *skip)
+{
+  set *labels = NULL;
+  char *label;
+  bitVect *clobbered;
+  unsigned int regs = 0;
+  lineNode *pl;
+  int i;
+
+  /* labels the code jumps to locally */
+  for (pl = head; pl; pl = pl->next)
+    if (pl->isLabel && pl->line)
+      {
+        const char *colon = strchr (pl->line, ':');
+
+        if (colon)
+          addSet (&labels, Safe_strndup (pl->line, colon - pl->line));
+      }
+
+  for (pl = head; pl && regs != REGS_ALL; pl = pl->next)
+    if (!isinSet (skip, pl))
+      regs |= lineRegs (pl, labels);
+
+  for (i = 0, clobbered = newBitVect (IYH_IDX + 1); i <= IYH_IDX; i++)
+    if (regs & (1 << i))
+      clobbered = bitVectSetBit (clobbered, i);
+
+  for (label = setFirstItem (labels); label; label = setNextItem (labels))
+    Safe_free (label);
+  deleteSet (&labels);
+
+  return clobbered;
+}
@@ -28,3 +28,4 @@ bool z80canAssign (const char *dst, const char *src, const char *exotic);
 bool z80symmParmStack (void);
 int z80instructionSize(lineNode *node);
 
+bitVect *z80RegsClobbered (lineNode *head, set *skip);
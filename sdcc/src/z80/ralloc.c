@@ -580,7 +580,7 @@ selectSpil (iCode * ic, eBBlock * ebp, symbol * forSym)
   if ((selectS = liveRangesWith (lrcs, directSpilLoc, ebp, ic)))
     {
       sym = leastUsedLR (selectS);
-      strcpy (sym->rname, (sym->usl.spillLoc->rname[0] ? sym->usl.spillLoc->rname : sym->usl.spillLoc->name));
+      sym->rname = (sym->usl.spillLoc->rname[0] ? sym->usl.spillLoc->rname : sym->usl.spillLoc->name);
       sym->spildir = 1;
       /* mark it as allocation required */
       sym->usl.spillLoc->allocreq++;
@@ -3089,7 +3089,9 @@ z80_oldralloc (ebbIndex * ebbi)
   /* redo that offsets for stacked automatic variables */
   redoStackOffsets ();
 
+  timerBegin ("genCode");
   genZ80Code (ic);
+  timerEnd ("genCode");
 
   /* free up any stackSpil locations allocated */
   applyToSet (_G.stackSpil, deallocStackSpil);
@@ -3156,7 +3158,9 @@ z80_ralloc (ebbIndex *ebbi)
   joinPushes (iCodeLabelOptimize(iCodeFromeBBlock (ebbs, count)));
 
   /* The new register allocator invokes its magic */
+  timerBegin ("ralloc2");
   ic = z80_ralloc2_cc (ebbi);
+  timerEnd ("ralloc2");
 
   RegFix (ebbs, count);
 
@@ -3184,7 +3188,9 @@ z80_ralloc (ebbIndex *ebbi)
   /* redo that offsets for stacked automatic variables */
   redoStackOffsets ();
 
+  timerBegin ("genCode");
   genZ80Code (ic);
+  timerEnd ("genCode");
 
   /* free up any stackSpil locations allocated */
   applyToSet (_G.stackSpil, deallocStackSpil);
@@ -26,7 +26,7 @@
 extern "C"
 {
   #include "z80.h"
-  unsigned char dryZ80iCode (iCode * ic);
+  float dryZ80iCode (iCode * ic);
   bool z80_assignment_optimal;
   bool should_omit_frame_ptr;
 };
@@ -1671,7 +1671,10 @@ iCode *z80_ralloc2_cc(ebbIndex *ebbi)
 
   guessCounts (ic, ebbi);
 
+  static allocs_budget budget("register allocation", 0.6, 40000);
+  budget.begin(tree_decomposition);
   z80_assignment_optimal = !tree_dec_ralloc(tree_decomposition, control_flow_graph, conflict_graph);
+  budget.end();
 
   return(ic);
 }
@@ -0,0 +1,233 @@
+from __future__ import print_function
+import sys, os, json, time, shutil, tempfile, subprocess
+from optparse import OptionParser
+
+"""Measures sdcc itself rather than the code it generates: compiles a
+fixed corpus for each port and records per file the wall time, the peak
+RSS, the peephole rule matches tried and the nodes and assignments of the
+tree decomposition register allocator. The results are written as JSON
+and compared against a baseline from an earlier run; the exit status is
+1 if a file got slower, bigger or needed more work than the baseline
+allows."""
+
+# Counters written by sdcc --time-trace, with the names used in the results
+COUNTERS = {
+    "peephole rule tries": "peep_tries",
+    "ralloc2 nodes": "ralloc_nodes",
+    "ralloc2 assignments": "ralloc_assignments",
+}
+
+# Synthetic sources that have caused compile time trouble before
+
+def stress_switch():
+    """Deep switch statements."""
+    out = ["int stress_switch(int a, int b, int c)", "{", "  int r = 0;"]
+    out.append("  switch (a)")
+    out.append("    {")
+    for i in range(16):
+        out.append("    case %d:" % (i * 3))
+        out.append("      switch (b)")
+        out.append("        {")
+        for j in range(4):
+            out.append("        case %d:" % j)
+            out.append("          switch (c & 7)")
+            out.append("            {")
+            for k in range(4):
+                out.append("            case %d: r += %d; break;" % (k, i * 100 + j * 10 + k))
+            out.append("            default: r ^= %d;" % (i + j))
+            out.append("            }")
+            out.append("          break;")
+        out.append("        }")
+        out.append("      break;")
+    out.append("    }")
+    out.append("  return r;")
+    out.append("}")
+    return out
+
+def stress_locals():
+    """Many locals that are live at the same time."""
+    n = 24
+    out = ["extern int in[8];", "extern long out[8];", "", "void stress_locals(void)", "{"]
+    for i in range(n):
+        out.append("  int v%d = in[%d] + %d;" % (i, i % 8, i))
+    for i in range(n):
+        out.append("  long w%d = (long)v%d * v%d;" % (i, i, (i * 7 + 3) % n))
+    for i in range(n):
+        out.append("  out[%d] += w%d - v%d;" % (i % 8, i, (i * 5 + 1) % n))
+    out.append("}")
+    return out
+
+def stress_straight():
+    """Long straight-line code."""
+    out = ["unsigned char g[32];", "", "unsigned int stress_straight(unsigned int x, unsigned int y)", "{"]
+    for i in range(60):
+        op = ("+", "^", "-", "|", "&")[i % 5]
+        out.append("  x = (x %s g[%d]) + (y << %d);" % (op, i % 32, i % 7))
+        if i % 3 == 0:
+            out.append("  y ^= x >> %d;" % (i % 5 + 1))
+    out.append("  return x + y;")
+    out.append("}")
+    return out
+
+STRESS = [stress_switch, stress_locals, stress_straight]
+
+def write_stress(dir):
+    names = []
+    for gen in STRESS:
+        name = os.path.join(dir, gen.__name__ + ".c")
+        fp = open(name, "w")
+        fp.write("/* " + gen.__doc__ + " Generated by compile-bench.py */\n\n")
+        fp.write("\n".join(gen()) + "\n")
+        fp.close()
+        names.append(name)
+    return names
+
+def regression_cases(dir):
+    """The first iteration of each test, generated by generate-cases.py."""
+    cases = []
+    for test in sorted(os.listdir(dir)):
+        tdir = os.path.join(dir, test)
+        if not os.path.isdir(tdir):
+            continue
+        files = sorted(f for f in os.listdir(tdir) if f.endswith(".c"))
+        if files:
+            cases.append(os.path.join(tdir, files[0]))
+    return cases
+
+def run_sdcc(cmd):
+    """Runs sdcc, returns whether it succeeded, its wall time and peak RSS in kB."""
+    devnull = open(os.devnull, "w")
+    start = time.time()
+    p = subprocess.Popen(cmd, stdout = devnull, stderr = devnull)
+    if hasattr(os, "wait4"):
+        status, usage = os.wait4(p.pid, 0)[1:]
+        wall = time.time() - start
+        p.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else 1
+        rss = usage.ru_maxrss
+        if sys.platform == "darwin":
+            rss //= 1024
+    else:
+        p.wait()
+        wall = time.time() - start
+        rss = 0
+    devnull.close()
+    return p.returncode == 0, wall, rss
+
+def read_counters(trace):
+    """The counters sdcc reported, older versions may not have them all."""
+    result = {}
+    fp = open(trace)
+    for e in json.load(fp)["traceEvents"]:
+        if e.get("cat") == "counter" and e["name"] in COUNTERS:
+            result[COUNTERS[e["name"]]] = e["args"]["value"]
+    fp.close()
+    return result
+
+def bench(opts, sources):
+    tmp = tempfile.mkdtemp(prefix = "compile-bench")
+    trace = os.path.join(tmp, "trace.json")
+    results = {}
+    try:
+        for port in opts.ports.split():
+            res = results.setdefault(port, {})
+            failed = 0
+            for src in sources:
+                name = src[1]
+                r = None
+                for i in range(opts.runs):
+                    cmd = [opts.sdcc, "-m" + port, "-S", "--time-trace", trace, "-o", os.path.join(tmp, "")]
+                    cmd += opts.flags + [src[0]]
+                    ok, wall, rss = run_sdcc(cmd)
+                    if not ok:
+                        r = {"failed": True}
+                        failed += 1
+                        break
+                    if r is None or wall < r["time"]:
+                        r = {"time": round(wall, 4), "rss": rss}
+                        r.update(read_counters(trace))
+                res[name] = r
+            total = sum(r["time"] for r in res.values() if "time" in r)
+            print("%-8s %5d files %8.1f s, %d failed to compile" % (port, len(sources), total, failed))
+    finally:
+        shutil.rmtree(tmp)
+    return results
+
+def compare(results, base, opts):
+    """Prints the files that got worse than the baseline, returns their number."""
+    limit = 1 + opts.threshold / 100.0
+    worse = 0
+    for port in sorted(results):
+        if port not in base:
+            continue
+        rows = []
+        for name in sorted(results[port]):
+            new, old = results[port][name], base[port].get(name)
+            if not old or "failed" in old:
+                continue
+            if "failed" in new:
+                rows.append((name, "compiled before, fails now"))
+                continue
+            if new["time"] > old["time"] * limit and new["time"] - old["time"] >= opts.min_time:
+                rows.append((name, "time %.3f s -> %.3f s" % (old["time"], new["time"])))
+            if new["rss"] > old["rss"] * limit and new["rss"] - old["rss"] >= 1024:
+                rows.append((name, "peak RSS %d kB -> %d kB" % (old["rss"], new["rss"])))
+            for c in sorted(COUNTERS.values()):
+                if c in old and c in new and new[c] > old[c] * limit and new[c] - old[c] > 100:
+                    rows.append((name, "%s %d -> %d" % (c, old[c], new[c])))
+
+        both = [n for n in results[port] if "time" in results[port][n] and "time" in base[port].get(n, {})]
+        old_total = sum(base[port][n]["time"] for n in both)
+        new_total = sum(results[port][n]["time"] for n in both)
+        print("%-8s total %.1f s -> %.1f s for %d files" % (port, old_total, new_total, len(both)))
+        for name, what in rows:
+            print("  %-40s %s" % (name, what))
+        worse += len(rows)
+    return worse
+
+def main():
+    parser = OptionParser(usage = "usage: %prog [options] [sources]")
+    parser.add_option("--sdcc", default = "sdcc", help = "sdcc to measure")
+    parser.add_option("--ports", default = "mcs51 z80 hc08 stm8", help = "ports to compile for")
+    parser.add_option("--cases", help = "directory with the generated regression test cases")
+    parser.add_option("--lib", help = "directory with library sources, e.g. device/lib")
+    parser.add_option("--stress", help = "directory to write the synthetic stress sources to")
+    parser.add_option("--flags", default = "", help = "additional sdcc options")
+    parser.add_option("-I", dest = "include", action = "append", default = [], help = "include directory")
+    parser.add_option("-n", dest = "runs", type = "int", default = 1, help = "runs per file, the fastest is kept")
+    parser.add_option("-o", dest = "output", help = "file to write the results to")
+    parser.add_option("--baseline", help = "results of an earlier run to compare with")
+    parser.add_option("--threshold", type = "float", default = 25, help = "increase in percent that counts as a regression")
+    parser.add_option("--min-time", type = "float", default = 0.1, help = "ignore time increases below this many seconds")
+    (opts, args) = parser.parse_args()
+
+    opts.flags = ["-I" + i for i in opts.include] + opts.flags.split()
+
+    # (path, name in the results)
+    sources = [(a, os.path.basename(a)) for a in args]
+    if opts.cases:
+        sources += [(c, "tests/" + os.path.basename(os.path.dirname(c))) for c in regression_cases(opts.cases)]
+    if opts.lib:
+        sources += [(os.path.join(opts.lib, f), "lib/" + f) for f in sorted(os.listdir(opts.lib)) if f.endswith(".c")]
+    if opts.stress:
+        if not os.path.isdir(opts.stress):
+            os.makedirs(opts.stress)
+        sources += [(s, "stress/" + os.path.basename(s)) for s in write_stress(opts.stress)]
+    if not sources:
+        parser.error("nothing to compile")
+
+    results = bench(opts, sources)
+    if opts.output:
+        fp = open(opts.output, "w")
+        json.dump(results, fp, indent = 1, sort_keys = True, separators = (",", ": "))
+        fp.write("\n")
+        fp.close()
+
+    if opts.baseline and os.path.exists(opts.baseline):
+        fp = open(opts.baseline)
+        base = json.load(fp)
+        fp.close()
+        if compare(results, base, opts):
+            sys.exit(1)
+
+if __name__ == '__main__':
+    main()
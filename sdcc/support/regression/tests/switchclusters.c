@@ -0,0 +1,262 @@
+/** Switch statements with case values in several dense clusters,
+    lowered to jump tables for the clusters.
+
+    type: char, int, long
+    sign: signed, unsigned
+    speed: 0, 1
+ */
+#include <testfwk.h>
+
+#if {speed}
+#pragma opt_code_speed
+#endif
+
+{sign} {type}
+clusterSwitch({sign} {type} val)
+{
+  switch (val)
+    {
+    case 2:
+      return 1;
+    case 3:
+      return 2;
+    case 4:
+    case 5:
+      return 3;
+    case 7:
+      return 4;
+    case 8:
+      return 5;
+    case 30:
+      return 6;
+    case 50:
+      return 7;
+    case 51:
+      return 8;
+    case 52:
+      return 9;
+    case 54:
+      return 10;
+    case 55:
+      return 11;
+    case 56:
+      return 12;
+    case 57:
+      return 13;
+    case 80:
+      return 14;
+    case 110:
+      return 15;
+    case 111:
+      return 16;
+    case 112:
+      return 17;
+    case 113:
+      return 18;
+    case 115:
+      return 19;
+    case 116:
+      return 20;
+    }
+  return 0;
+}
+
+void
+testClusterSwitch(void)
+{
+  ASSERT(clusterSwitch(0) == 0);
+  ASSERT(clusterSwitch(1) == 0);
+  ASSERT(clusterSwitch(2) == 1);
+  ASSERT(clusterSwitch(3) == 2);
+  ASSERT(clusterSwitch(4) == 3);
+  ASSERT(clusterSwitch(5) == 3);
+  ASSERT(clusterSwitch(6) == 0);
+  ASSERT(clusterSwitch(7) == 4);
+  ASSERT(clusterSwitch(8) == 5);
+  ASSERT(clusterSwitch(9) == 0);
+  ASSERT(clusterSwitch(29) == 0);
+  ASSERT(clusterSwitch(30) == 6);
+  ASSERT(clusterSwitch(31) == 0);
+  ASSERT(clusterSwitch(49) == 0);
+  ASSERT(clusterSwitch(50) == 7);
+  ASSERT(clusterSwitch(52) == 9);
+  ASSERT(clusterSwitch(53) == 0);
+  ASSERT(clusterSwitch(57) == 13);
+  ASSERT(clusterSwitch(58) == 0);
+  ASSERT(clusterSwitch(80) == 14);
+  ASSERT(clusterSwitch(109) == 0);
+  ASSERT(clusterSwitch(110) == 15);
+  ASSERT(clusterSwitch(113) == 18);
+  ASSERT(clusterSwitch(114) == 0);
+  ASSERT(clusterSwitch(116) == 20);
+  ASSERT(clusterSwitch(117) == 0);
+  ASSERT(clusterSwitch(127) == 0);
+  ASSERT(clusterSwitch(({sign} {type})-1) == 0);
+  ASSERT(clusterSwitch(({sign} {type})-50) == 0);
+}
+
+{sign} {type}
+tableSwitch({sign} {type} val)
+{
+  switch (val)
+    {
+    case 20: return 1;
+    case 21: return 2;
+    case 22: return 3;
+    case 23: return 4;
+    case 24: return 5;
+    case 25: return 6;
+    case 26: return 7;
+    case 27: return 8;
+    case 28: return 9;
+    case 29: return 10;
+    case 100: return 11;
+    case 101: return 12;
+    case 102: return 13;
+    case 103: return 14;
+    case 105: return 15;
+    case 106: return 16;
+    case 107: return 17;
+    case 108: return 18;
+    case 109: return 19;
+    case 110: return 20;
+    }
+  return 0;
+}
+
+void
+testTableSwitch(void)
+{
+  ASSERT(tableSwitch(0) == 0);
+  ASSERT(tableSwitch(19) == 0);
+  ASSERT(tableSwitch(20) == 1);
+  ASSERT(tableSwitch(25) == 6);
+  ASSERT(tableSwitch(29) == 10);
+  ASSERT(tableSwitch(30) == 0);
+  ASSERT(tableSwitch(99) == 0);
+  ASSERT(tableSwitch(100) == 11);
+  ASSERT(tableSwitch(104) == 0);
+  ASSERT(tableSwitch(105) == 15);
+  ASSERT(tableSwitch(110) == 20);
+  ASSERT(tableSwitch(111) == 0);
+  ASSERT(tableSwitch(({sign} {type})-20) == 0);
+  ASSERT(tableSwitch(({sign} {type})(20 + 256)) == (sizeof({type}) == 1 ? 1 : 0));
+}
+
+long
+wideSwitch(long val)
+{
+  switch (val)
+    {
+    case -100000:
+      return 1;
+    case -40:
+      return 2;
+    case -39:
+      return 3;
+    case -38:
+      return 4;
+    case -36:
+      return 5;
+    case -35:
+      return 6;
+    case -1:
+      return 7;
+    case 0:
+      return 8;
+    case 1000:
+      return 9;
+    case 1001:
+      return 10;
+    case 1002:
+      return 11;
+    case 1004:
+      return 12;
+    case 1005:
+      return 13;
+    case 70000:
+      return 14;
+    case 2000000000:
+      return 15;
+    }
+  return 0;
+}
+
+void
+testWideSwitch(void)
+{
+  ASSERT(wideSwitch(-2000000000) == 0);
+  ASSERT(wideSwitch(-100000) == 1);
+  ASSERT(wideSwitch(-99999) == 0);
+  ASSERT(wideSwitch(-41) == 0);
+  ASSERT(wideSwitch(-40) == 2);
+  ASSERT(wideSwitch(-38) == 4);
+  ASSERT(wideSwitch(-37) == 0);
+  ASSERT(wideSwitch(-35) == 6);
+  ASSERT(wideSwitch(-34) == 0);
+  ASSERT(wideSwitch(-1) == 7);
+  ASSERT(wideSwitch(0) == 8);
+  ASSERT(wideSwitch(1) == 0);
+  ASSERT(wideSwitch(999) == 0);
+  ASSERT(wideSwitch(1000) == 9);
+  ASSERT(wideSwitch(1003) == 0);
+  ASSERT(wideSwitch(1005) == 13);
+  ASSERT(wideSwitch(1006) == 0);
+  ASSERT(wideSwitch(70000) == 14);
+  ASSERT(wideSwitch(70000 + 65536) == 0);
+  ASSERT(wideSwitch(1000 + 65536) == 0);
+  ASSERT(wideSwitch(2000000000) == 15);
+  ASSERT(wideSwitch(2000000001) == 0);
+}
+
+unsigned long
+unsignedWideSwitch(unsigned long val)
+{
+  switch (val)
+    {
+    case 0:
+      return 1;
+    case 1:
+      return 2;
+    case 3:
+      return 3;
+    case 4:
+      return 4;
+    case 5:
+      return 5;
+    case 6:
+      return 6;
+    case 300:
+      return 7;
+    case 40000:
+      return 8;
+    case 40001:
+      return 9;
+    case 40003:
+      return 10;
+    case 40004:
+      return 11;
+    case 40005:
+      return 12;
+    case 0x7fffffff:
+      return 13;
+    }
+  return 0;
+}
+
+void
+testUnsignedWideSwitch(void)
+{
+  ASSERT(unsignedWideSwitch(0) == 1);
+  ASSERT(unsignedWideSwitch(2) == 0);
+  ASSERT(unsignedWideSwitch(6) == 6);
+  ASSERT(unsignedWideSwitch(7) == 0);
+  ASSERT(unsignedWideSwitch(300) == 7);
+  ASSERT(unsignedWideSwitch(40000) == 8);
+  ASSERT(unsignedWideSwitch(40002) == 0);
+  ASSERT(unsignedWideSwitch(40005) == 12);
+  ASSERT(unsignedWideSwitch(40005 + 65536) == 0);
+  ASSERT(unsignedWideSwitch(0x7fffffff) == 13);
+  ASSERT(unsignedWideSwitch(0x80000000) == 0);
+  ASSERT(unsignedWideSwitch(0xffffffff) == 0);
+}
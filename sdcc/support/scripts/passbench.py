@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+
+# passbench - replays a corpus of preprocessed sources through sdcc and
+# reports the time and memory taken by each optimizer pass
+#
+# This file is part of sdcc.
+#
+#  This program is free software; you can redistribute it and/or modify it
+#  under the terms of the GNU General Public License as published by the
+#  Free Software Foundation; either version 2, or (at your option) any
+#  later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+
+# A corpus is a directory of preprocessed sources together with the
+# options they are compiled with, so that any sdcc revision can replay it
+# without the include files of the original project:
+#
+#   passbench.py capture -o corpus -- -mz80 -Iinclude foo.c bar.c
+#   passbench.py run -n 3 -j results-old.json corpus
+#   passbench.py run -n 3 --sdcc new/bin/sdcc -j results-new.json corpus
+#   passbench.py compare results-old.json results-new.json
+#
+# Each source is compiled with --time-trace. The time and allocation of a
+# pass exclude the passes nested in it, e.g. genCode is not counted in
+# assignRegisters. Of several runs (-n), the fastest one of each function
+# and pass is kept.
+
+import sys
+import os
+import json
+import shlex
+import shutil
+import tempfile
+import subprocess
+import argparse
+
+OPTIONS_FILE = "options"
+
+# options only used by the preprocessor, with and without an argument
+CPP_ARG_OPTIONS = ("-I", "-D", "-U", "-isystem", "-include")
+CPP_OPTIONS = ("-nostdinc",)
+
+MODULE = "(module)"
+
+def split_args(args):
+    '''Separates the sources, preprocessor options and compiler options.'''
+    sources, cpp, cc = [], [], []
+    i = 0
+    while i < len(args):
+        a = args[i]
+        if a.endswith(".c") and not a.startswith("-"):
+            sources.append(a)
+        elif a in CPP_ARG_OPTIONS:
+            cpp += args[i:i + 2]
+            i += 1
+        elif a.startswith(CPP_ARG_OPTIONS) or a in CPP_OPTIONS:
+            cpp.append(a)
+        else:
+            cc.append(a)
+        i += 1
+    return sources, cpp, cc
+
+def run_sdcc(cmd):
+    '''Runs sdcc, returns whether it succeeded and its peak RSS in kB.'''
+    p = subprocess.Popen(cmd, stdout = subprocess.DEVNULL, stderr = subprocess.PIPE)
+    err = p.stderr.read()
+    p.stderr.close()
+    if hasattr(os, "wait4"):
+        status, usage = os.wait4(p.pid, 0)[1:]
+        ok = os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0
+        rss = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+    else:
+        ok = p.wait() == 0
+        rss = 0
+    if not ok:
+        sys.stderr.write(err.decode(errors = "replace"))
+    return ok, rss
+
+def read_trace(name):
+    '''Time (s) and allocation (bytes) of each function and pass.'''
+    with open(name) as f:
+        events = json.load(f)["traceEvents"]
+    result = {}
+    for e in events:
+        if e["cat"] != "pass":
+            continue
+        args = e["args"]
+        key = "%s\t%s" % (args.get("function", MODULE), e["name"])
+        r = result.setdefault(key, [0.0, 0])
+        r[0] += args["self"] / 1e6
+        r[1] += args["selfAlloc"]
+    return result
+
+def capture(opts):
+    sources, cpp, cc = split_args(opts.args)
+    if not sources:
+        sys.exit("passbench: no source files given")
+    os.makedirs(opts.output, exist_ok = True)
+    for src in sources:
+        dst = os.path.join(opts.output, os.path.basename(src))
+        if os.path.exists(dst) and not opts.force:
+            sys.exit("passbench: %s exists, use -f to replace it" % dst)
+        with open(dst, "wb") as f:
+            if subprocess.call([opts.sdcc, "-E"] + cpp + cc + [src], stdout = f):
+                sys.exit("passbench: preprocessing %s failed" % src)
+        print("captured %s" % dst)
+    with open(os.path.join(opts.output, OPTIONS_FILE), "w") as f:
+        f.write(" ".join(shlex.quote(a) for a in cc) + "\n")
+
+def run(opts):
+    with open(os.path.join(opts.corpus, OPTIONS_FILE)) as f:
+        options = shlex.split(f.read())
+    options += shlex.split(opts.options or "")
+    sources = sorted(s for s in os.listdir(opts.corpus) if s.endswith(".c"))
+    if opts.files:
+        sources = [s for s in sources if s in opts.files]
+
+    tmp = tempfile.mkdtemp(prefix = "passbench")
+    trace = os.path.join(tmp, "trace.json")
+    results = {"sdcc": opts.sdcc, "options": options, "files": {}}
+    try:
+        for src in sources:
+            best = None
+            rss = 0
+            for i in range(opts.runs):
+                cmd = [opts.sdcc] + options + ["-S", "--time-trace", trace,
+                       "-o", os.path.join(tmp, ""), os.path.join(opts.corpus, src)]
+                ok, r = run_sdcc(cmd)
+                if not ok:
+                    sys.exit("passbench: %s failed" % src)
+                rss = max(rss, r)
+                passes = read_trace(trace)
+                if best is None:
+                    best = passes
+                else:
+                    for k, v in passes.items():
+                        if k in best:
+                            best[k][0] = min(best[k][0], v[0])
+            results["files"][src] = {"rss": rss, "passes": best}
+            sys.stderr.write("%s: %.3f s, %d kB\n" % (src, sum(v[0] for v in best.values()), rss))
+    finally:
+        shutil.rmtree(tmp)
+
+    if opts.json:
+        with open(opts.json, "w") as f:
+            json.dump(results, f, indent = 1, sort_keys = True)
+    report(results, opts)
+
+def pass_totals(results, wanted):
+    '''Time and allocation of each pass over the whole corpus.'''
+    totals = {}
+    for data in results["files"].values():
+        for k, v in data["passes"].items():
+            name = k.split("\t")[1]
+            if wanted and name not in wanted:
+                continue
+            t = totals.setdefault(name, [0.0, 0])
+            t[0] += v[0]
+            t[1] += v[1]
+    return totals
+
+def report(results, opts):
+    totals = pass_totals(results, opts.passes)
+    print("%-28s %10s %12s" % ("pass", "time (s)", "alloc (kB)"))
+    for name, t in sorted(totals.items(), key = lambda x: -x[1][0]):
+        print("%-28s %10.3f %12d" % (name, t[0], t[1] // 1024))
+
+    slow = []
+    for src, data in results["files"].items():
+        for k, v in data["passes"].items():
+            func, name = k.split("\t")
+            if func != MODULE and (not opts.passes or name in opts.passes):
+                slow.append((v[0], src, func, name, v[1]))
+    slow.sort(reverse = True)
+    print("\n%-20s %-28s %-20s %10s %12s" % ("file", "function", "pass", "time (s)", "alloc (kB)"))
+    for t, src, func, name, alloc in slow[:opts.top]:
+        print("%-20s %-28s %-20s %10.3f %12d" % (src, func, name, t, alloc // 1024))
+
+def compare(opts):
+    with open(opts.old) as f:
+        old = json.load(f)
+    with open(opts.new) as f:
+        new = json.load(f)
+    limit = opts.threshold / 100.0
+
+    def changed(a, b):
+        return b > a * (1 + limit) or b < a * (1 - limit)
+
+    old_totals = pass_totals(old, opts.passes)
+    new_totals = pass_totals(new, opts.passes)
+    print("%-28s %10s %10s %8s %12s %12s" % ("pass", "old (s)", "new (s)", "change", "old (kB)", "new (kB)"))
+    for name in sorted(set(old_totals) | set(new_totals)):
+        o = old_totals.get(name, [0.0, 0])
+        n = new_totals.get(name, [0.0, 0])
+        change = "%+7.1f%%" % ((n[0] - o[0]) * 100 / o[0]) if o[0] else "new"
+        print("%-28s %10.3f %10.3f %8s %12d %12d" % (name, o[0], n[0], change, o[1] // 1024, n[1] // 1024))
+
+    # single functions whose passes changed noticeably
+    rows = []
+    for src in sorted(set(old["files"]) & set(new["files"])):
+        op, np = old["files"][src]["passes"], new["files"][src]["passes"]
+        for k in sorted(set(op) & set(np)):
+            func, name = k.split("\t")
+            if opts.passes and name not in opts.passes:
+                continue
+            if max(op[k][0], np[k][0]) >= opts.min_time and changed(op[k][0], np[k][0]):
+                rows.append((np[k][0] - op[k][0], src, func, name, op[k][0], np[k][0]))
+    if rows:
+        rows.sort(reverse = True)
+        print("\n%-20s %-28s %-20s %10s %10s" % ("file", "function", "pass", "old (s)", "new (s)"))
+        for d, src, func, name, o, n in rows:
+            print("%-20s %-28s %-20s %10.3f %10.3f" % (src, func, name, o, n))
+
+    rss = [(src, old["files"][src]["rss"], new["files"][src]["rss"])
+           for src in sorted(set(old["files"]) & set(new["files"]))]
+    rss = [r for r in rss if changed(r[1], r[2])]
+    if rss:
+        print("\n%-20s %12s %12s" % ("file", "old RSS (kB)", "new RSS (kB)"))
+        for src, o, n in rss:
+            print("%-20s %12d %12d" % (src, o, n))
+
+def main():
+    '''Replays preprocessed sources through sdcc and times its passes.'''
+    parser = argparse.ArgumentParser(description = main.__doc__)
+    sub = parser.add_subparsers(dest = "command")
+    sub.required = True
+
+    p = sub.add_parser("capture", help = "preprocess sources into a corpus")
+    p.add_argument("-o", dest = "output", required = True, help = "corpus directory")
+    p.add_argument("-f", dest = "force", action = "store_true", help = "replace sources in the corpus")
+    p.add_argument("--sdcc", default = "sdcc", help = "sdcc to preprocess with")
+    p.add_argument("args", nargs = argparse.REMAINDER, help = "sdcc options and sources")
+    p.set_defaults(func = capture)
+
+    p = sub.add_parser("run", help = "time the passes on a corpus")
+    p.add_argument("corpus", help = "corpus directory")
+    p.add_argument("files", nargs = "*", help = "only these sources of the corpus")
+    p.add_argument("--sdcc", default = "sdcc", help = "sdcc to benchmark")
+    p.add_argument("--options", help = "additional sdcc options")
+    p.add_argument("-n", dest = "runs", type = int, default = 1, help = "runs per source, the fastest is kept")
+    p.add_argument("-p", dest = "passes", action = "append", help = "only report this pass (repeatable)")
+    p.add_argument("-t", dest = "top", type = int, default = 20, help = "number of slowest functions listed")
+    p.add_argument("-j", dest = "json", help = "write the results to this file")
+    p.set_defaults(func = run)
+
+    p = sub.add_parser("compare", help = "compare two result files")
+    p.add_argument("old")
+    p.add_argument("new")
+    p.add_argument("-p", dest = "passes", action = "append", help = "only compare this pass (repeatable)")
+    p.add_argument("--threshold", type = float, default = 10, help = "change in percent to list (default 10)")
+    p.add_argument("--min-time", type = float, default = 0.01, help = "ignore functions faster than this (s)")
+    p.set_defaults(func = compare)
+
+    opts = parser.parse_args()
+    if opts.func == capture and opts.args and opts.args[0] == "--":
+        opts.args = opts.args[1:]
+    opts.func(opts)
+
+if __name__ == '__main__':
+    main()
@@ -24,6 +24,7 @@
 #include <string.h>
 #include <memory.h>
 #include <assert.h>
+#include <stddef.h>
 #include "newalloc.h"
 
 #if OPT_ENABLE_LIBGC
@@ -47,6 +48,9 @@
 
 #define TRACEMALLOC	0
 
+/* Number of bytes requested from the heap so far */
+size_t Safe_allocated;
+
 #if TRACEMALLOC
 enum
 {
@@ -138,6 +142,7 @@ Safe_realloc (void *OldPtr, size_t NewSize)
   void *NewPtr;
 
   NewPtr = REALLOC (OldPtr, NewSize);
+  Safe_allocated += NewSize;
 
   if (!NewPtr)
     {
@@ -163,6 +168,7 @@ Safe_calloc (size_t Elements, size_t Size)
   void *NewPtr;
 
   NewPtr = MALLOC (Elements * Size);
+  Safe_allocated += Elements * Size;
 #if TRACEMALLOC
   _log (Elements * Size);
 #endif
@@ -193,6 +199,7 @@ Safe_malloc (size_t Size)
   void *NewPtr;
 
   NewPtr = MALLOC (Size);
+  Safe_allocated += Size;
 
 #if TRACEMALLOC
   _log (Size);
@@ -275,3 +282,137 @@ freeTrace (allocTrace * ptrace)
   ptrace->palloced = NULL;
   ptrace->max = 0;
 }
+
+/*
+-------------------------------------------------------------------------------
+Arena allocation - blocks are carved out of large chunks and released in bulk
+
+-------------------------------------------------------------------------------
+*/
+
+enum
+{
+  ARENA_CHUNK_SIZE = 64 * 1024
+};
+
+typedef union
+{
+  long l;
+  double d;
+  void *p;
+} arenaAlign;
+
+struct _allocArenaChunk
+{
+  allocArenaChunk *next;
+  size_t size;                  /* usable size of data[] */
+  size_t used;
+  arenaAlign data[1];
+};
+
+#define ARENA_ALIGN(_s)  (((_s) + sizeof (arenaAlign) - 1) & ~(sizeof (arenaAlign) - 1))
+
+static allocArenaChunk *
+_newArenaChunk (allocArena * parena, size_t size)
+{
+  allocArenaChunk *chunk;
+
+  if (size < ARENA_CHUNK_SIZE)
+    size = ARENA_CHUNK_SIZE;
+
+  chunk = Safe_malloc (offsetof (allocArenaChunk, data) + size);
+  chunk->size = size;
+  chunk->used = 0;
+
+  parena->reserved += size;
+  if (parena->reserved > parena->peak)
+    parena->peak = parena->reserved;
+
+  return chunk;
+}
+
+void *
+arenaAlloc (allocArena * parena, size_t size)
+{
+  allocArenaChunk *chunk;
+  void *p;
+
+  assert (parena);
+
+  size = ARENA_ALIGN (size ? size : 1);
+  chunk = parena->chunks;
+
+  if (!chunk || chunk->size - chunk->used < size)
+    {
+      chunk = _newArenaChunk (parena, size);
+      if (parena->chunks && size >= ARENA_CHUNK_SIZE)
+        {
+          /* keep filling the current chunk after a large request */
+          chunk->next = parena->chunks->next;
+          parena->chunks->next = chunk;
+        }
+      else
+        {
+          chunk->next = parena->chunks;
+          parena->chunks = chunk;
+        }
+    }
+
+  p = (char *) chunk->data + chunk->used;
+  chunk->used += size;
+  memset (p, 0, size);
+
+  parena->num++;
+  parena->used += size;
+  parena->totalNum++;
+  parena->totalUsed += size;
+
+  return p;
+}
+
+char *
+arenaStrdup (allocArena * parena, const char *sz)
+{
+  size_t len;
+  char *pret;
+
+  assert (sz);
+
+  len = strlen (sz);
+  pret = arenaAlloc (parena, len + 1);
+  memcpy (pret, sz, len);
+
+  return pret;
+}
+
+void
+freeArena (allocArena * parena)
+{
+  allocArenaChunk *chunk, *keep = NULL;
+
+  assert (parena);
+
+  chunk = parena->chunks;
+  while (chunk)
+    {
+      allocArenaChunk *next = chunk->next;
+
+      if (!keep && chunk->size == ARENA_CHUNK_SIZE)
+        {
+          keep = chunk;
+          keep->used = 0;
+          keep->next = NULL;
+        }
+      else
+        {
+          parena->reserved -= chunk->size;
+          FREE (chunk);
+        }
+      chunk = next;
+    }
+
+  parena->chunks = keep;
+  parena->num = 0;
+  parena->used = 0;
+  parena->frees++;
+}
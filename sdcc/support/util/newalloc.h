@@ -32,6 +32,29 @@ typedef struct _allocTrace
   void **palloced;
 } allocTrace;
 
+typedef struct _allocArenaChunk allocArenaChunk;
+
+/** An arena hands out many small zeroed blocks which are all released
+    together by freeArena (). The statistics are kept for --mem-stats.
+*/
+typedef struct _allocArena
+{
+  const char *name;             /* name used in the statistics */
+  allocArenaChunk *chunks;      /* chunk list, current chunk first */
+  size_t num;                   /* number of allocations since last free */
+  size_t used;                  /* bytes handed out since last free */
+  size_t reserved;              /* bytes currently held in chunks */
+  size_t peak;                  /* maximum of reserved */
+  size_t totalNum;              /* number of allocations ever */
+  size_t totalUsed;             /* bytes ever handed out */
+  int frees;                    /* number of freeArena () calls */
+} allocArena;
+
+/** Number of bytes requested through Safe_malloc, Safe_calloc and
+    Safe_realloc so far.
+ */
+extern size_t Safe_allocated;
+
 /*
 -------------------------------------------------------------------------------
 Clear_realloc - Reallocate a memory block and clear any memory added with
@@ -96,4 +119,17 @@ void *traceAlloc (allocTrace * ptrace, void *p);
  */
 void freeTrace (allocTrace * ptrace);
 
+/** Allocates a zeroed block of memory from the arena.
+ */
+void *arenaAlloc (allocArena * parena, size_t size);
+
+/** Creates a copy of a string in the arena.
+ */
+char *arenaStrdup (allocArena * parena, const char *sz);
+
+/** Releases all the memory allocated from the arena at once. One chunk
+    is kept for reuse by the next round of allocations.
+*/
+void freeArena (allocArena * parena);
+
 #endif